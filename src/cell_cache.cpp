@@ -0,0 +1,91 @@
+#include "cell_cache.hpp"
+
+#include <functional>
+#include <unordered_map>
+
+#include <hyprland/src/desktop/view/LayerSurface.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/protocols/core/Compositor.hpp>
+
+namespace HTCellCache {
+
+struct SWatch {
+    WP<CWLSurfaceResource> surface;
+    CHyprSignalListener commit;
+};
+
+static uint64_t global_generation = 1;
+static std::unordered_map<WORKSPACEID, uint64_t> ws_generations;
+// Keyed by surface, a window's subsurfaces are watched for the window
+static std::unordered_map<const CWLSurfaceResource*, SWatch> watches;
+
+uint64_t generation(WORKSPACEID ws_id) {
+    const auto it = ws_generations.find(ws_id);
+    return global_generation + (it != ws_generations.end() ? it->second : 0);
+}
+
+void invalidate() {
+    global_generation++;
+}
+
+static void prune() {
+    std::erase_if(watches, [](const auto& entry) { return entry.second.surface.expired(); });
+}
+
+static void watch_surface(SP<CWLSurfaceResource> surface, std::function<void()> on_commit) {
+    if (surface == nullptr)
+        return;
+    // A destroyed surface's address can be reused by a new one
+    const auto it = watches.find(surface.get());
+    if (it != watches.end() && !it->second.surface.expired())
+        return;
+    watches[surface.get()] = {surface, surface->m_events.commit.listen(std::move(on_commit))};
+}
+
+void watch_window(PHLWINDOW window) {
+    if (window == nullptr || window->wlSurface() == nullptr)
+        return;
+    const SP<CWLSurfaceResource> resource = window->wlSurface()->resource();
+    if (resource == nullptr)
+        return;
+    // The workspace is looked up on commit, the window may have moved since
+    const PHLWINDOWREF window_ref = window;
+    resource->breadthfirst(
+        [&window_ref](SP<CWLSurfaceResource> surface, const Vector2D& offset, void* data) {
+            watch_surface(surface, [window_ref] {
+                if (const PHLWINDOW w = window_ref.lock())
+                    ws_generations[w->workspaceID()]++;
+            });
+        },
+        nullptr
+    );
+}
+
+bool watch_layers(PHLMONITOR monitor) {
+    if (monitor == nullptr)
+        return false;
+    prune();
+    bool settled = true;
+    for (const auto& level : monitor->m_layerSurfaceLayers) {
+        for (const PHLLSREF& layer_ref : level) {
+            const PHLLS layer = layer_ref.lock();
+            if (layer == nullptr || layer->m_surface == nullptr)
+                continue;
+            // Bars and wallpapers are drawn in every cell
+            watch_surface(layer->m_surface->resource(), [] { invalidate(); });
+            if (layer->m_fadingOut || layer->m_alpha->isBeingAnimated()
+                || layer->m_realPosition->isBeingAnimated()
+                || layer->m_realSize->isBeingAnimated())
+                settled = false;
+        }
+    }
+    return settled;
+}
+
+void shutdown() {
+    watches.clear();
+    ws_generations.clear();
+}
+
+} // namespace HTCellCache
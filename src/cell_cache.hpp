@@ -0,0 +1,27 @@
+#pragma once
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <cstdint>
+
+// When a cell captured into the layout's cell cache has to be drawn again. Every surface of a
+// captured window is watched for commits, which bump its workspace's generation; layer
+// surface commits and anything that changes how all cells look bump every generation
+namespace HTCellCache {
+
+// Changes whenever anything drawn into the workspace's cell may have changed
+uint64_t generation(WORKSPACEID ws_id);
+
+// Watch the surface tree of a window about to be captured
+void watch_window(PHLWINDOW window);
+// Watch the monitor's layer surfaces. Returns false while any of them is animating, which
+// changes every cell without a commit
+bool watch_layers(PHLMONITOR monitor);
+
+// Window opened, closed or moved, focus or config changed
+void invalidate();
+
+// Drops every listener, before the plugin is unloaded
+void shutdown();
+
+} // namespace HTCellCache
@@ -0,0 +1,91 @@
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace HTConfig {
+
+struct KeyGroup {
+    const char* key;
+    HTConfigChange group;
+};
+
+static constexpr std::array INT_KEYS = {
+    KeyGroup {"grid:rows", HT_CONFIG_SLOTS},
+    KeyGroup {"grid:cols", HT_CONFIG_SLOTS},
+    KeyGroup {"grid:layers", HT_CONFIG_SLOTS},
+    KeyGroup {"grid:loop", HT_CONFIG_NAV},
+    KeyGroup {"grid:loop_layers", HT_CONFIG_NAV},
+    KeyGroup {"grid:gaps_use_aspect_ratio", HT_CONFIG_GEOMETRY},
+    KeyGroup {"linear:top", HT_CONFIG_GEOMETRY},
+    KeyGroup {"bg_color", HT_CONFIG_RENDER},
+    KeyGroup {"linear:blur", HT_CONFIG_RENDER},
+    KeyGroup {"cell_blur", HT_CONFIG_RENDER},
+    KeyGroup {"cell_cache", HT_CONFIG_RENDER},
+    KeyGroup {"search:highlight_color", HT_CONFIG_RENDER},
+    KeyGroup {"exit_on_hovered", HT_CONFIG_OTHER},
+    KeyGroup {"warp_on_move_window", HT_CONFIG_OTHER},
+    KeyGroup {"close_overview_on_reload", HT_CONFIG_OTHER},
+    KeyGroup {"drag_button", HT_CONFIG_OTHER},
+    KeyGroup {"select_button", HT_CONFIG_OTHER},
+    KeyGroup {"gestures:enabled", HT_CONFIG_OTHER},
+    KeyGroup {"gestures:move_fingers", HT_CONFIG_OTHER},
+    KeyGroup {"gestures:open_fingers", HT_CONFIG_OTHER},
+    KeyGroup {"gestures:open_positive", HT_CONFIG_OTHER},
+    KeyGroup {"search:enabled", HT_CONFIG_OTHER},
+};
+
+static constexpr std::array FLOAT_KEYS = {
+    KeyGroup {"gap_size", HT_CONFIG_GEOMETRY},
+    KeyGroup {"linear:height", HT_CONFIG_GEOMETRY},
+    KeyGroup {"border_size", HT_CONFIG_RENDER},
+    KeyGroup {"cell_blur_live_scale", HT_CONFIG_RENDER},
+    KeyGroup {"gestures:move_distance", HT_CONFIG_OTHER},
+    KeyGroup {"gestures:open_distance", HT_CONFIG_OTHER},
+    KeyGroup {"linear:scroll_speed", HT_CONFIG_OTHER},
+};
+
+static std::string gradient_string(const char* key) {
+    const CConfigValue<Config::IComplexConfigValue> value(key);
+    return ((Config::CGradientValueData*)value.ptr())->toString();
+}
+
+Snapshot snapshot() {
+    Snapshot result;
+    result.layout = value<Config::STRING>("layout");
+
+    result.ints.reserve(INT_KEYS.size());
+    for (const KeyGroup& k : INT_KEYS)
+        result.ints.push_back(value<Config::INTEGER>(k.key));
+    result.floats.reserve(FLOAT_KEYS.size());
+    for (const KeyGroup& k : FLOAT_KEYS)
+        result.floats.push_back(value<Config::FLOAT>(k.key));
+
+    const auto& bindings = ht_manager->get_rule_bindings().bound_monitor;
+    result.rule_bindings.assign(bindings.begin(), bindings.end());
+    std::sort(result.rule_bindings.begin(), result.rule_bindings.end());
+
+    result.active_border = gradient_string("general:col.active_border");
+    result.inactive_border = gradient_string("general:col.inactive_border");
+    return result;
+}
+
+uint32_t diff(const Snapshot& old_snapshot, const Snapshot& new_snapshot) {
+    uint32_t changes = HT_CONFIG_NONE;
+    if (old_snapshot.layout != new_snapshot.layout)
+        changes |= HT_CONFIG_LAYOUT;
+    for (size_t i = 0; i < INT_KEYS.size(); i++)
+        if (old_snapshot.ints[i] != new_snapshot.ints[i])
+            changes |= INT_KEYS[i].group;
+    for (size_t i = 0; i < FLOAT_KEYS.size(); i++)
+        if (old_snapshot.floats[i] != new_snapshot.floats[i])
+            changes |= FLOAT_KEYS[i].group;
+    if (old_snapshot.rule_bindings != new_snapshot.rule_bindings)
+        changes |= HT_CONFIG_SLOTS;
+    if (old_snapshot.active_border != new_snapshot.active_border
+        || old_snapshot.inactive_border != new_snapshot.inactive_border)
+        changes |= HT_CONFIG_RENDER;
+    return changes;
+}
+
+} // namespace HTConfig
@@ -25,3 +25,39 @@ inline T value(std::string config) {
 }
 
 } // namespace HTConfig
+
+// What a config reload invalidates, as a bitmask
+enum HTConfigChange : uint32_t {
+    HT_CONFIG_NONE = 0,
+    // the layout name
+    HT_CONFIG_LAYOUT = 1 << 0,
+    // grid dimensions and workspace rule bindings, which decide the slot maps
+    HT_CONFIG_SLOTS = 1 << 1,
+    // grid looping, which only affects navigation
+    HT_CONFIG_NAV = 1 << 2,
+    // gaps and linear strip placement, which decide the cell boxes
+    HT_CONFIG_GEOMETRY = 1 << 3,
+    // colours, border size and blur, read every frame
+    HT_CONFIG_RENDER = 1 << 4,
+    // values only read when handling input
+    HT_CONFIG_OTHER = 1 << 5,
+    HT_CONFIG_ALL = (1 << 6) - 1,
+};
+
+namespace HTConfig {
+
+// The plugin config values and the manager's rule bindings, as of one reload
+struct Snapshot {
+    Config::STRING layout;
+    std::vector<Config::INTEGER> ints;
+    std::vector<Config::FLOAT> floats;
+    std::vector<std::pair<WORKSPACEID, MONITORID>> rule_bindings;
+    std::string active_border;
+    std::string inactive_border;
+};
+
+Snapshot snapshot();
+// HTConfigChange bits for every group that differs between the snapshots
+uint32_t diff(const Snapshot& old_snapshot, const Snapshot& new_snapshot);
+
+} // namespace HTConfig
@@ -0,0 +1,153 @@
+#include "events.hpp"
+
+#include <format>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/managers/EventManager.hpp>
+
+namespace HTEvents {
+
+enum eKind {
+    HT_EVENT_OPEN,
+    HT_EVENT_LAYER,
+    HT_EVENT_MOVE,
+    HT_EVENT_SLOTS,
+    HT_EVENT_DROP,
+};
+
+struct SPending {
+    // Monitor name, which is what consumers know monitors by
+    std::string monitor;
+    eKind kind;
+    // Open state, layer or workspace id, depending on kind
+    WORKSPACEID value = 0;
+    // nullopt for a workspace that lost its slot
+    std::map<WORKSPACEID, std::optional<HTGridSlot>> slots;
+};
+
+// In the order each monitor and kind was first reported in, later reports update in place
+static std::vector<SPending> pending;
+static wl_event_source* flush_source = nullptr;
+
+static void post(const char* kind, const std::string& monitor) {
+    g_pEventManager->postEvent(SHyprIPCEvent {"hyprtasking", std::format("{},{}", kind, monitor)});
+}
+
+static void post(const char* kind, const std::string& monitor, const std::string& args) {
+    g_pEventManager->postEvent(
+        SHyprIPCEvent {"hyprtasking", std::format("{},{},{}", kind, monitor, args)}
+    );
+}
+
+static void flush() {
+    for (const SPending& p : pending) {
+        switch (p.kind) {
+            case HT_EVENT_OPEN:
+                post(p.value ? "show" : "hide", p.monitor);
+                break;
+            case HT_EVENT_LAYER:
+                post("layer", p.monitor, std::to_string(p.value));
+                break;
+            case HT_EVENT_MOVE:
+                post("move", p.monitor, std::to_string(p.value));
+                break;
+            case HT_EVENT_SLOTS: {
+                if (p.slots.empty())
+                    break;
+                // ID:LAYER:X:Y for new or moved slots, -ID for removed ones, separated by ';'
+                std::string args;
+                for (const auto& [id, slot] : p.slots) {
+                    if (!args.empty())
+                        args += ';';
+                    if (slot)
+                        args += std::format("{}:{}:{}:{}", id, slot->layer, slot->x, slot->y);
+                    else
+                        args += std::format("-{}", id);
+                }
+                post("slots", p.monitor, args);
+                break;
+            }
+            case HT_EVENT_DROP:
+                post("drop", p.monitor, std::to_string(p.value));
+                break;
+        }
+    }
+    pending.clear();
+}
+
+static int on_idle(void* data) {
+    flush_source = nullptr;
+    flush();
+    return 0;
+}
+
+static SPending* pending_for(PHLMONITOR monitor, eKind kind) {
+    if (monitor == nullptr)
+        return nullptr;
+    if (flush_source == nullptr)
+        flush_source = wl_event_loop_add_idle(g_pCompositor->m_wlEventLoop, on_idle, nullptr);
+    for (SPending& p : pending) {
+        if (p.kind == kind && p.monitor == monitor->m_name)
+            return &p;
+    }
+    return &pending.emplace_back(SPending {.monitor = monitor->m_name, .kind = kind});
+}
+
+void show(PHLMONITOR monitor) {
+    if (SPending* p = pending_for(monitor, HT_EVENT_OPEN))
+        p->value = true;
+}
+
+void hide(PHLMONITOR monitor) {
+    if (SPending* p = pending_for(monitor, HT_EVENT_OPEN))
+        p->value = false;
+}
+
+void layer(PHLMONITOR monitor, int layer) {
+    if (SPending* p = pending_for(monitor, HT_EVENT_LAYER))
+        p->value = layer;
+}
+
+void move(PHLMONITOR monitor, WORKSPACEID ws_id) {
+    if (SPending* p = pending_for(monitor, HT_EVENT_MOVE))
+        p->value = ws_id;
+}
+
+void slots(
+    PHLMONITOR monitor,
+    const std::unordered_map<WORKSPACEID, HTGridSlot>& prior,
+    const std::unordered_map<WORKSPACEID, HTGridSlot>& current
+) {
+    SPending* p = pending_for(monitor, HT_EVENT_SLOTS);
+    if (p == nullptr)
+        return;
+    for (const auto& [id, slot] : current) {
+        const auto it = prior.find(id);
+        if (it == prior.end() || it->second.layer != slot.layer || it->second.x != slot.x
+            || it->second.y != slot.y)
+            p->slots[id] = slot;
+    }
+    for (const auto& [id, slot] : prior) {
+        if (!current.contains(id))
+            p->slots[id] = std::nullopt;
+    }
+}
+
+void drop(PHLMONITOR monitor, WORKSPACEID ws_id) {
+    if (SPending* p = pending_for(monitor, HT_EVENT_DROP))
+        p->value = ws_id;
+}
+
+void shutdown() {
+    if (flush_source != nullptr)
+        wl_event_source_remove(flush_source);
+    flush_source = nullptr;
+    pending.clear();
+}
+
+} // namespace HTEvents
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <unordered_map>
+
+#include "layout/grid.hpp"
+
+// Overview state changes pushed to Hyprland's event socket (socket2) as
+// `hyprtasking>>KIND,MONITOR[,ARGS]`. Everything reported within one event loop iteration
+// is coalesced per monitor and kind, latest value wins, and posted once the loop goes idle
+// in the order each monitor and kind was first reported
+namespace HTEvents {
+
+void show(PHLMONITOR monitor);
+void hide(PHLMONITOR monitor);
+void layer(PHLMONITOR monitor, int layer);
+void move(PHLMONITOR monitor, WORKSPACEID ws_id);
+// Reports the slots that differ between prior and current
+void slots(
+    PHLMONITOR monitor,
+    const std::unordered_map<WORKSPACEID, HTGridSlot>& prior,
+    const std::unordered_map<WORKSPACEID, HTGridSlot>& current
+);
+void drop(PHLMONITOR monitor, WORKSPACEID ws_id);
+
+// Drops anything not yet posted, called before the plugin is unloaded
+void shutdown();
+
+} // namespace HTEvents
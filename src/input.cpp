@@ -1,17 +1,25 @@
 #include <linux/input-event-codes.h>
+#include <xkbcommon/xkbcommon.h>
 
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/macros.hpp>
 #include <hyprland/src/managers/KeybindManager.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/managers/PointerManager.hpp>
+#include <hyprland/src/managers/SeatManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 
 #include "config.hpp"
+#include "events.hpp"
+#include "latency.hpp"
 #include "manager.hpp"
 #include "overview.hpp"
+#include "search.hpp"
+#include "src/desktop/state/FocusState.hpp"
+#include "trace.hpp"
 
 bool HTManager::start_window_drag() {
+    HT_TRACE_SCOPE("drag_start");
     const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
     const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
     if (cursor_monitor == nullptr || cursor_view == nullptr || !cursor_view->active
@@ -24,6 +32,10 @@ bool HTManager::start_window_drag() {
         return true;
     }
 
+    // Windows in spread are not where the layout thinks they are, so they can't be dragged
+    if (cursor_view->layout->spread.active())
+        return true;
+
     const Vector2D mouse_coords = g_pInputManager->getMouseCoordsInternal();
     const WORKSPACEID workspace_id = cursor_view->layout->get_ws_id_from_global(mouse_coords);
     PHLWORKSPACE cursor_workspace = g_pCompositor->getWorkspaceByID(workspace_id);
@@ -34,6 +46,7 @@ bool HTManager::start_window_drag() {
 
     // PHLWORKSPACEREF o_workspace = cursor_monitor->m_activeWorkspace;
     cursor_monitor->changeWorkspace(cursor_workspace, true);
+    HTLatency::mark(HT_INTERACTION_DRAG, cursor_monitor);
 
     const Vector2D workspace_coords =
         cursor_view->layout->global_to_local_ws_unscaled(mouse_coords, workspace_id)
@@ -73,10 +86,12 @@ bool HTManager::start_window_drag() {
     // if (o_workspace != nullptr)
     //     cursor_monitor->changeWorkspace(o_workspace.lock(), true);
 
+    cursor_view->request_frame();
     return true;
 }
 
 bool HTManager::end_window_drag() {
+    HT_TRACE_SCOPE("drag_end");
     const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
     const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
     if (cursor_monitor == nullptr || cursor_view == nullptr) {
@@ -136,11 +151,13 @@ bool HTManager::end_window_drag() {
     }
 
     Log::logger->log(LOG, "[Hyprtasking] trying to drop window on ws {}", cursor_workspace->m_id);
+    HTLatency::mark(HT_INTERACTION_DRAG, cursor_monitor);
 
     // PHLWORKSPACEREF o_workspace = cursor_monitor->m_activeWorkspace;
     cursor_monitor->changeWorkspace(cursor_workspace, true);
 
     g_pCompositor->moveWindowToWorkspaceSafe(dragged_window, cursor_workspace);
+    HTEvents::drop(cursor_monitor, cursor_workspace->m_id);
 
     // Inverts the scale-around-mouse remap that start_window_drag applies for
     // tiled drags; without it, the post-close m_realPosition reads as
@@ -185,6 +202,22 @@ bool HTManager::exit_to_workspace() {
     if (!cursor_view->active || !cursor_view->layout->should_manage_mouse())
         return false;
 
+    // In spread, pick the clicked window instead of leaving the overview
+    HTSpread& spread = cursor_view->layout->spread;
+    if (spread.active()) {
+        const PHLWINDOW window = spread.window_at(
+            cursor_view->get_monitor(),
+            g_pInputManager->getMouseCoordsInternal()
+        );
+        if (window != nullptr) {
+            cursor_view->move_id(window->workspaceID(), false);
+            Desktop::focusState()->fullWindowFocus(window, Desktop::FOCUS_REASON_CLICK);
+        }
+        spread.close();
+        cursor_view->request_frame();
+        return true;
+    }
+
     for (PHTVIEW view : views) {
         if (view == nullptr)
             continue;
@@ -198,28 +231,112 @@ bool HTManager::on_mouse_move() {
 }
 
 bool HTManager::on_mouse_axis(double delta) {
-    const PHTVIEW cursor_view = get_view_from_cursor();
+    const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
+    const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
     if (cursor_view == nullptr)
         return false;
 
-    return cursor_view->layout->on_mouse_axis(delta);
+    const bool handled = cursor_view->layout->on_mouse_axis(delta);
+    if (handled) {
+        HTLatency::mark(HT_INTERACTION_SCROLL, cursor_monitor);
+        cursor_view->request_frame();
+    }
+    return handled;
+}
+
+bool HTManager::on_key(IKeyboard::SKeyEvent e) {
+    if (e.state != WL_KEYBOARD_KEY_STATE_PRESSED)
+        return search_keys.erase(e.keycode) > 0;
+
+    if (!overview_engaged() || !HTConfig::value<Config::INTEGER>("search:enabled"))
+        return false;
+
+    const PHTVIEW cursor_view = get_view_from_cursor();
+    if (cursor_view == nullptr || !cursor_view->active || cursor_view->closing)
+        return false;
+
+    // Leave anything with a modifier to keybinds
+    const uint32_t mods = g_pInputManager->getModsFromAllKBs();
+    if (mods & ~(HL_MODIFIER_SHIFT | HL_MODIFIER_CAPS | HL_MODIFIER_MOD2))
+        return false;
+
+    const SP<IKeyboard> keyboard = g_pSeatManager->m_keyboard.lock();
+    if (keyboard == nullptr || keyboard->m_xkbState == nullptr)
+        return false;
+
+    const xkb_keycode_t keycode = e.keycode + 8;
+    bool handled = false;
+    switch (xkb_state_key_get_one_sym(keyboard->m_xkbState, keycode)) {
+        case XKB_KEY_Return:
+        case XKB_KEY_KP_Enter:
+            handled = jump_to_search_match();
+            break;
+        case XKB_KEY_Escape:
+            handled = !HTSearch::query().empty();
+            HTSearch::clear_query();
+            break;
+        case XKB_KEY_BackSpace:
+            handled = !HTSearch::query().empty();
+            HTSearch::pop();
+            break;
+        case XKB_KEY_Tab:
+            handled = HTSearch::selected() != nullptr;
+            HTSearch::select_next();
+            break;
+        default: {
+            char utf8[16];
+            const int len =
+                xkb_state_key_get_utf8(keyboard->m_xkbState, keycode, utf8, sizeof(utf8));
+            if (len <= 0 || (unsigned char)utf8[0] < 0x20 || utf8[0] == 0x7f)
+                break;
+            HTSearch::append(std::string(utf8, len));
+            handled = true;
+            break;
+        }
+    }
+    if (!handled)
+        return false;
+
+    search_keys.insert(e.keycode);
+    // Matches are highlighted on every open overview
+    for (PHTVIEW view : views) {
+        if (view != nullptr && view->active)
+            view->request_frame();
+    }
+    return true;
+}
+
+bool HTManager::jump_to_search_match() {
+    const PHLWINDOW window = HTSearch::selected();
+    if (window == nullptr || window->m_workspace == nullptr)
+        return false;
+    const PHTVIEW view = get_view_from_monitor(window->m_monitor.lock());
+    if (view == nullptr || view->closing)
+        return false;
+
+    view->move_id(window->workspaceID(), false);
+    Desktop::focusState()->fullWindowFocus(window, Desktop::FOCUS_REASON_CLICK);
+    HTSearch::clear_query();
+    return true;
 }
 
 void HTManager::swipe_start() {
+    HT_TRACE_SCOPE("swipe_start");
     swipe_state = HT_SWIPE_NONE;
     swipe_amt = 0.0;
 }
 
 bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
+    HT_TRACE_SCOPE("swipe_update");
+    const int ENABLED = HTConfig::value<Config::INTEGER>("gestures:enabled");
+    if (!ENABLED)
+        return false;
+
     const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
     const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
     if (cursor_view == nullptr)
         return false;
 
-    const int ENABLED = HTConfig::value<Config::INTEGER>("gestures:enabled");
-    if (!ENABLED)
-        return false;
-
     const unsigned int MOVE_FINGERS = HTConfig::value<Config::INTEGER>("gestures:move_fingers");
     const float OPEN_DISTANCE = HTConfig::value<Config::FLOAT>("gestures:open_distance");
     const unsigned int OPEN_FINGERS = HTConfig::value<Config::INTEGER>("gestures:open_fingers");
@@ -254,6 +371,7 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
         }
 
         if (swipe_state == HT_SWIPE_OPEN) {
+            HTLatency::mark(HT_INTERACTION_OPEN, cursor_monitor);
             swipe_amt += deltaY;
             const float swipe_perc = 1.0 - std::clamp(swipe_amt / OPEN_DISTANCE, 0.01f, 1.0f);
             cursor_view->layout->close_open_lerp(swipe_perc);
@@ -268,15 +386,16 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
             } else {
                 swipe_state = HT_SWIPE_MOVE;
                 cursor_view->navigating = true;
+                update_overview_state();
 
                 cursor_view->layout->init_position();
                 // need to schedule frames for monitor, otherwise the screen doesn't re-render
-                g_pHyprRenderer->damageMonitor(cursor_monitor);
-                g_pCompositor->scheduleFrameForMonitor(cursor_monitor);
+                cursor_view->request_frame();
             }
         }
 
         if (swipe_state == HT_SWIPE_MOVE) {
+            HTLatency::mark(HT_INTERACTION_NAVIGATE, cursor_monitor);
             cursor_view->layout->on_move_swipe(e.delta);
         }
     }
@@ -284,6 +403,7 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
 }
 
 bool HTManager::swipe_end() {
+    HT_TRACE_SCOPE("swipe_end");
     const PHTVIEW cursor_view = get_view_from_cursor();
     if (cursor_view == nullptr || swipe_state == HT_SWIPE_NONE)
         return false;
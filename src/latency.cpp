@@ -0,0 +1,134 @@
+#include "latency.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <unordered_map>
+#include <vector>
+
+#include <aquamarine/output/Output.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+
+namespace HTLatency {
+
+static constexpr size_t MAX_SAMPLES = 1024;
+static constexpr const char* INTERACTION_NAMES[] = {"open", "close", "navigate", "drag", "scroll"};
+
+struct SSamples {
+    // Ring of the last MAX_SAMPLES latencies in microseconds
+    std::vector<uint64_t> values;
+    size_t head = 0;
+};
+
+struct SMonitorState {
+    CHyprSignalListener presented;
+    // Start of the oldest unpresented mark per interaction, 0 if none
+    std::array<uint64_t, HT_INTERACTION_COUNT> pending {};
+};
+
+static std::array<SSamples, HT_INTERACTION_COUNT> samples;
+static std::unordered_map<MONITORID, SMonitorState> monitors;
+
+static uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+    )
+        .count();
+}
+
+static void add_sample(HTInteraction interaction, uint64_t latency_us) {
+    SSamples& s = samples[interaction];
+    if (s.values.size() < MAX_SAMPLES) {
+        s.values.push_back(latency_us);
+        return;
+    }
+    s.values[s.head] = latency_us;
+    s.head = (s.head + 1) % MAX_SAMPLES;
+}
+
+// when is the presentation feedback time, on CLOCK_MONOTONIC like steady_clock
+static void on_presented(MONITORID monitor_id, const timespec* when) {
+    const auto it = monitors.find(monitor_id);
+    if (it == monitors.end())
+        return;
+    const uint64_t now = when != nullptr ? (uint64_t)when->tv_sec * 1000000 + when->tv_nsec / 1000
+                                         : now_us();
+    for (size_t i = 0; i < HT_INTERACTION_COUNT; i++) {
+        uint64_t& start = it->second.pending[i];
+        // A mark newer than the frame's presentation waits for the next frame
+        if (start == 0 || now < start)
+            continue;
+        add_sample((HTInteraction)i, now - start);
+        start = 0;
+    }
+}
+
+void mark(HTInteraction interaction, PHLMONITOR monitor) {
+    if (monitor == nullptr)
+        return;
+    const auto it = monitors.find(monitor->m_id);
+    if (it == monitors.end())
+        return;
+    uint64_t& start = it->second.pending[interaction];
+    if (start == 0)
+        start = now_us();
+}
+
+void watch_monitor(PHLMONITOR monitor) {
+    if (monitor == nullptr || monitors.contains(monitor->m_id))
+        return;
+    const MONITORID monitor_id = monitor->m_id;
+    if (monitor->m_output == nullptr)
+        return;
+    monitors[monitor_id].presented = monitor->m_output->events.present.listen(
+        [monitor_id](const Aquamarine::IOutput::SPresentEvent& event) {
+            if (event.presented)
+                on_presented(monitor_id, event.when);
+        }
+    );
+}
+
+void unwatch_monitor(MONITORID monitor_id) {
+    monitors.erase(monitor_id);
+}
+
+void shutdown() {
+    monitors.clear();
+}
+
+std::string report() {
+    std::string result;
+    for (size_t i = 0; i < HT_INTERACTION_COUNT; i++) {
+        std::vector<uint64_t> sorted = samples[i].values;
+        if (sorted.empty()) {
+            result += std::format("{}: no samples\n", INTERACTION_NAMES[i]);
+            continue;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))] / 1000.0;
+        };
+        result += std::format(
+            "{}: n={} p50={:.2f}ms p90={:.2f}ms p99={:.2f}ms max={:.2f}ms\n",
+            INTERACTION_NAMES[i],
+            sorted.size(),
+            percentile(0.5),
+            percentile(0.9),
+            percentile(0.99),
+            sorted.back() / 1000.0
+        );
+    }
+    return result;
+}
+
+void reset() {
+    for (SSamples& s : samples) {
+        s.values.clear();
+        s.head = 0;
+    }
+    for (auto& [id, state] : monitors)
+        state.pending.fill(0);
+}
+
+} // namespace HTLatency
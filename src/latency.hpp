@@ -0,0 +1,32 @@
+#pragma once
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <string>
+
+// Input-to-photon latency of overview interactions: a handled input marks its
+// monitor, and the next frame presented on that monitor closes the sample
+enum HTInteraction {
+    HT_INTERACTION_OPEN,
+    HT_INTERACTION_CLOSE,
+    HT_INTERACTION_NAVIGATE,
+    HT_INTERACTION_DRAG,
+    HT_INTERACTION_SCROLL,
+    HT_INTERACTION_COUNT,
+};
+
+namespace HTLatency {
+
+// Only the oldest unpresented mark per monitor and interaction is kept
+void mark(HTInteraction interaction, PHLMONITOR monitor);
+
+void watch_monitor(PHLMONITOR monitor);
+void unwatch_monitor(MONITORID monitor_id);
+// Drops every present listener, before the plugin is unloaded
+void shutdown();
+
+// Percentiles per interaction type, one line each
+std::string report();
+void reset();
+
+} // namespace HTLatency
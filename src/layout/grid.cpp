@@ -12,19 +12,20 @@
 #include <hyprland/src/managers/animation/DesktopAnimationManager.hpp>
 #include <hyprland/src/config/shared/animation/AnimationTree.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
-#include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/render/Renderer.hpp>
-#include <hyprland/src/render/pass/BorderPassElement.hpp>
-#include <hyprland/src/render/pass/RectPassElement.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 #include <hyprutils/utils/ScopeGuard.hpp>
 
 #include "../config.hpp"
+#include "../events.hpp"
 #include "../globals.hpp"
 #include "../overview.hpp"
 #include "../render.hpp"
+#include "../slot_store.hpp"
+#include "../snapshot.hpp"
+#include "../trace.hpp"
 #include "../types.hpp"
 #include "src/layout/target/Target.hpp"
 
@@ -65,6 +66,7 @@ WORKSPACEID HTLayoutGrid::slot_workspace(int layer, int x, int y) {
 void HTLayoutGrid::refresh_workspace_cache(
     const std::unordered_set<WORKSPACEID>& extra_off_limits
 ) {
+    HT_TRACE_SCOPE("grid:refresh_workspace_cache");
     const PHLMONITOR monitor = get_monitor();
     if (monitor == nullptr)
         return;
@@ -75,7 +77,12 @@ void HTLayoutGrid::refresh_workspace_cache(
     if (ROWS <= 0 || COLS <= 0 || LAYERS <= 0)
         return;
 
-    const auto prior = ws_slot_cache;
+    // A fresh view (plugin reload, compositor restart) picks up where this monitor left off
+    auto prior = ws_slot_cache;
+    if (prior.empty()) {
+        if (const auto* stored = HTSlotStore::get(monitor->m_description))
+            prior = *stored;
+    }
 
     ws_slot_cache.clear();
     slot_ws_cache.clear();
@@ -133,81 +140,51 @@ void HTLayoutGrid::refresh_workspace_cache(
     // could silently switch monitors. extra_off_limits carries IDs already
     // claimed by sibling views in this refresh.
     std::unordered_set<WORKSPACEID> off_limits = extra_off_limits;
-    const auto& ws_manager = Config::workspaceRuleMgr();
-    const auto& all_rules = ws_manager->getAllWorkspaceRules();
-    for (const auto& rule : all_rules) {
-        if (rule.m_workspaceId > 0)
-            off_limits.insert(rule.m_workspaceId);
-    }
-    for (const auto& w : g_pCompositor->getWorkspacesCopy()) {
-        if (w == nullptr)
+    for (const auto& [id, mid] : ht_manager->get_rule_bindings().bound_monitor)
+        off_limits.insert(id);
+    for (const PHLMONITOR& other : g_pCompositor->m_monitors) {
+        if (other == nullptr || other->m_id == view_id)
             continue;
-        if (w->monitorID() != view_id)
-            off_limits.insert(w->m_id);
+        for (const WORKSPACEID id : ht_manager->get_monitor_workspaces(other->m_id).ids)
+            off_limits.insert(id);
     }
 
     size_t cursor = 0;
 
-    // Sort by workspaceId so slot assignment doesn't depend on config-line order.
-    std::vector<const Config::CWorkspaceRule*> rules_sorted;
-    rules_sorted.reserve(all_rules.size());
-    for (const auto& r : all_rules)
-        rules_sorted.push_back(&r);
-    std::sort(rules_sorted.begin(), rules_sorted.end(),
-              [](const Config::CWorkspaceRule* a, const Config::CWorkspaceRule* b) {
-                  return a->m_workspaceId < b->m_workspaceId;
-              });
-
-    for (const Config::CWorkspaceRule* rule : rules_sorted) {
-        if (rule->m_workspaceId <= 0)
-            continue;
-        if (extra_off_limits.count(rule->m_workspaceId))
+    // Sorted by workspaceId so slot assignment doesn't depend on config-line order.
+    for (const WORKSPACEID id : ht_manager->get_bound_workspaces(view_id)) {
+        if (extra_off_limits.count(id))
             continue;
-        const auto bound = Config::workspaceRuleMgr()->getBoundMonitorForWS(
-            rule->m_workspaceName.starts_with("name:")
-                ? rule->m_workspaceName.substr(5)
-                : rule->m_workspaceName
-        );
-        if (bound == nullptr || bound->m_id != view_id)
-            continue;
-        place_with_prior(rule->m_workspaceId, cursor);
+        place_with_prior(id, cursor);
     }
 
-    // Sort by m_id so slot assignment is independent of Hyprland's internal
-    // m_workspaces vector order.
-    std::vector<PHLWORKSPACE> on_monitor;
-    for (const auto& w : g_pCompositor->getWorkspacesCopy()) {
-        if (w == nullptr)
-            continue;
-        if (w->monitorID() != view_id)
-            continue;
-        if (w->m_id <= 0)
+    // The index is sorted by id so slot assignment is independent of Hyprland's
+    // internal m_workspaces vector order.
+    std::vector<WORKSPACEID> on_monitor;
+    for (const WORKSPACEID id : ht_manager->get_monitor_workspaces(view_id).ids) {
+        if (id <= 0)
             continue;
-        if (extra_off_limits.count(w->m_id))
+        if (extra_off_limits.count(id))
             continue;
-        on_monitor.push_back(w);
+        on_monitor.push_back(id);
     }
-    std::sort(on_monitor.begin(), on_monitor.end(),
-              [](const PHLWORKSPACE& a, const PHLWORKSPACE& b) {
-                  return a->m_id < b->m_id;
-              });
     // Settle workspaces that still have a free prior slot before assigning
     // anyone via the cursor — otherwise a migrated workspace with no prior
     // here would steal slot 0 and displace this monitor's resident at (0,0).
-    std::vector<PHLWORKSPACE> needs_cursor;
-    for (const auto& w : on_monitor) {
-        const auto pit = prior.find(w->m_id);
+    std::vector<WORKSPACEID> needs_cursor;
+    for (const WORKSPACEID id : on_monitor) {
+        const auto pit = prior.find(id);
         if (pit != prior.end()) {
             const long long idx = find_slot_index(pit->second);
             if (idx >= 0 && !taken[(size_t)idx]) {
-                place(w->m_id, (size_t)idx);
+                place(id, (size_t)idx);
                 continue;
             }
         }
-        needs_cursor.push_back(w);
+        needs_cursor.push_back(id);
     }
-    for (const auto& w : needs_cursor)
-        place_with_prior(w->m_id, cursor);
+    for (const WORKSPACEID id : needs_cursor)
+        place_with_prior(id, cursor);
 
     WORKSPACEID synth_candidate = 1;
     auto next_synth = [&]() -> WORKSPACEID {
@@ -226,6 +203,69 @@ void HTLayoutGrid::refresh_workspace_cache(
         const WORKSPACEID id = next_synth();
         place(id, i);
     }
+
+    const bool changed = prior.size() != ws_slot_cache.size()
+        || std::ranges::any_of(ws_slot_cache, [&](const auto& entry) {
+               const auto pit = prior.find(entry.first);
+               return pit == prior.end() || pit->second.layer != entry.second.layer
+                   || pit->second.x != entry.second.x || pit->second.y != entry.second.y;
+           });
+    if (changed) {
+        HTSlotStore::save(monitor->m_description, ws_slot_cache);
+        HTSnapshot::invalidate();
+        HTEvents::slots(monitor, prior, ws_slot_cache);
+    }
+
+    build_nav_graph();
+}
+
+void HTLayoutGrid::build_nav_graph() {
+    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
+    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
+    const int LAYERS = HTConfig::value<Config::INTEGER>("grid:layers");
+    const int LOOP = HTConfig::value<Config::INTEGER>("grid:loop");
+    const int LOOP_LAYERS = HTConfig::value<Config::INTEGER>("grid:loop_layers");
+
+    auto slot_at = [&](int l, int x, int y) {
+        if (LOOP) {
+            x = (x + COLS) % COLS;
+            y = (y + ROWS) % ROWS;
+        }
+        if (l < 0 || l >= LAYERS) {
+            if (!LOOP_LAYERS)
+                return WORKSPACE_INVALID;
+            l = ((l % LAYERS) + LAYERS) % LAYERS;
+        }
+        return slot_workspace(l, x, y);
+    };
+
+    nav_graph.clear();
+    nav_graph.reserve(ws_slot_cache.size());
+    for (const auto& [id, s] : ws_slot_cache) {
+        auto& neighbours = nav_graph[id];
+        neighbours[HT_DIR_UP] = slot_at(s.layer, s.x, s.y - 1);
+        neighbours[HT_DIR_DOWN] = slot_at(s.layer, s.x, s.y + 1);
+        neighbours[HT_DIR_LEFT] = slot_at(s.layer, s.x - 1, s.y);
+        neighbours[HT_DIR_RIGHT] = slot_at(s.layer, s.x + 1, s.y);
+        neighbours[HT_DIR_IN] = slot_at(s.layer - 1, s.x, s.y);
+        neighbours[HT_DIR_OUT] = slot_at(s.layer + 1, s.x, s.y);
+    }
+}
+
+WORKSPACEID HTLayoutGrid::get_neighbour(WORKSPACEID ws_id, HTDirection direction) {
+    if (direction >= HT_DIR_COUNT)
+        return WORKSPACE_INVALID;
+    const auto it = nav_graph.find(ws_id);
+    if (it == nav_graph.end())
+        return WORKSPACE_INVALID;
+    return it->second[direction];
+}
+
+int HTLayoutGrid::get_ws_layer(WORKSPACEID ws_id) {
+    const auto it = ws_slot_cache.find(ws_id);
+    if (it == ws_slot_cache.end())
+        return layer;
+    return it->second.layer;
 }
 
 std::string HTLayoutGrid::layout_name() {
@@ -253,7 +293,9 @@ WORKSPACEID HTLayoutGrid::get_ws_id_in_direction(int x, int y, std::string& dire
         x = (x + COLS) % COLS;
         y = (y + ROWS) % ROWS;
     }
-    return get_ws_id_from_xy(x, y);
+    // Resolve through the slot cache rather than overview_layout so callers can
+    // look up neighbours on a layer other than the one currently laid out
+    return slot_workspace(layer, x, y);
 }
 
 void HTLayoutGrid::on_move_swipe(Vector2D delta) {
@@ -378,6 +420,8 @@ bool HTLayoutGrid::should_render_window(PHLWINDOW window) {
     const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
     if (target != nullptr && window == target->window())
         return false;
+    if (is_occluded(window))
+        return false;
 
     PHLWORKSPACE workspace = window->m_workspace;
     if (workspace == nullptr)
@@ -392,6 +436,10 @@ bool HTLayoutGrid::should_render_window(PHLWINDOW window) {
     return ori_result;
 }
 
+bool HTLayoutGrid::is_animating() {
+    return scale->isBeingAnimated() || offset->isBeingAnimated();
+}
+
 float HTLayoutGrid::drag_window_scale() {
     return scale->value();
 }
@@ -408,8 +456,11 @@ void HTLayoutGrid::init_position() {
     // monitor. Fresh views (e.g. after monitor reconnect) start at layer 0,
     // so without this the overview would open on the wrong layer.
     const auto sit = ws_slot_cache.find(monitor->m_activeWorkspace->m_id);
-    if (sit != ws_slot_cache.end())
+    if (sit != ws_slot_cache.end() && layer != sit->second.layer) {
         layer = sit->second.layer;
+        HTSnapshot::invalidate();
+        HTEvents::layer(monitor, layer);
+    }
 
     build_overview_layout(HT_VIEW_CLOSED);
 
@@ -484,7 +535,10 @@ void HTLayoutGrid::build_overview_layout(HTViewStage stage) {
     const PHLMONITOR last_monitor = Desktop::focusState()->monitor();
     Desktop::focusState()->rawMonitorFocus(monitor);
 
-    overview_layout.clear();
+    // Cells are rendered at the unrounded animated scale
+    const double render_scale = stage == HT_VIEW_ANIMATING ? scale->value() : 0.;
+
+    begin_layout_update(monitor);
     for (int y = 0; y < ROWS; y++) {
         for (int x = 0; x < COLS; x++) {
             const WORKSPACEID ws_id = slot_workspace(layer, x, y);
@@ -492,17 +546,23 @@ void HTLayoutGrid::build_overview_layout(HTViewStage stage) {
                 continue;
             CBox ws_box = calculate_ws_box(x, y, stage);
             ws_box.round();
-            overview_layout[ws_id] = HTWorkspace {x, y, ws_box};
+            update_layout_ws(ws_id, x, y, ws_box, render_scale);
         }
     }
+    end_layout_update();
 
     if (last_monitor != nullptr)
         Desktop::focusState()->rawMonitorFocus(last_monitor);
 }
 
 void HTLayoutGrid::render() {
+    HT_TRACE_SCOPE("grid:render");
     HTLayoutBase::render();
-    CScopeGuard x([this] { post_render(); });
+    CScopeGuard x([this] {
+        HT_TRACE_SCOPE("grid:render:post");
+        post_render();
+    });
+    HTTraceScope phase("grid:render:setup");
 
     const PHTVIEW par_view = ht_manager->get_view_from_id(view_id);
     if (par_view == nullptr)
@@ -511,25 +571,15 @@ void HTLayoutGrid::render() {
     if (monitor == nullptr)
         return;
 
-    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-    static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
-
-    auto* const ACTIVECOL = (Config::CGradientValueData*)(PACTIVECOL.ptr());
-    auto* const INACTIVECOL = (Config::CGradientValueData*)(PINACTIVECOL.ptr());
-
     const float BORDERSIZE = HTConfig::value<Config::FLOAT>("border_size");
 
     const auto time = Time::steadyNow();
 
 
-    g_pHyprRenderer->damageMonitor(monitor);
-    g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
-    CBox monitor_box = {{0, 0}, monitor->m_transformedSize};
-
-    CRectPassElement::SRectData data;
-    data.color = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
-    data.box = monitor_box;
-    g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
+    schedule_next_frame(monitor);
+    if (HTConfig::value<Config::INTEGER>("cell_blur") != HT_CELL_BLUR_OFF)
+        g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
+    add_background({{0, 0}, monitor->m_transformedSize});
 
     // Do a dance with active workspaces: Hyprland will only properly render the
     // current active one so make the workspace active before rendering it, etc
@@ -544,8 +594,12 @@ void HTLayoutGrid::render() {
     start_workspace->m_visible = false;
 
     build_overview_layout(HT_VIEW_ANIMATING);
+    update_occlusion();
+    add_shared_layers(monitor);
+    begin_cell_cache(monitor);
 
     CBox global_mon_box = {monitor->m_position, monitor->m_transformedSize};
+    phase.next("grid:render:cells");
     for (const auto& [ws_id, ws_layout] : overview_layout) {
         // Skip if the box is empty
         if (ws_layout.box.width < 0.01 || ws_layout.box.height < 0.01)
@@ -554,11 +608,7 @@ void HTLayoutGrid::render() {
         // Could be nullptr, in which we render only layers
         const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
 
-        // renderModif translation used by renderWorkspace is weird so need
-        // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
-        CBox render_box = {{ws_layout.box.pos() / scale->value()}, ws_layout.box.size()};
-        if (monitor->m_transform % 2 == 1)
-            std::swap(render_box.w, render_box.h);
+        const CBox& render_box = ws_layout.render_box;
 
         // render active one last
         if (workspace == start_workspace && start_workspace != nullptr)
@@ -568,15 +618,6 @@ void HTLayoutGrid::render() {
         if (global_box.expand(BORDERSIZE).intersection(global_mon_box).empty())
             continue;
 
-        const Config::CGradientValueData border_col =
-            monitor->m_activeWorkspace->m_id == ws_id ? *ACTIVECOL : *INACTIVECOL;
-        CBox border_box = ws_layout.box;
-
-        CBorderPassElement::SBorderData data;
-        data.box = border_box;
-        data.grad1 = border_col;
-        data.borderSize = BORDERSIZE;
-
         if (workspace != nullptr) {
             monitor->m_activeWorkspace = workspace;
             g_pDesktopAnimationManager->startAnimation(
@@ -587,13 +628,7 @@ void HTLayoutGrid::render() {
             );
             workspace->m_visible = true;
 
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
+            render_cell(monitor, workspace, time, render_box);
 
             g_pDesktopAnimationManager->startAnimation(
                 workspace,
@@ -604,15 +639,9 @@ void HTLayoutGrid::render() {
             workspace->m_visible = false;
         } else {
             // If pWorkspace is null, then just render the layers
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
+            render_cell(monitor, workspace, time, render_box);
         }
-        g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+        queue_border(ws_layout.box, false);
     }
 
     monitor->m_activeWorkspace = start_workspace;
@@ -625,37 +654,26 @@ void HTLayoutGrid::render() {
     start_workspace->m_visible = true;
 
     // Render active workspace last so the dragging window is always on top when let go of
-    if (start_workspace != nullptr && overview_layout.count(start_workspace->m_id)) {
-        CBox ws_box = overview_layout[start_workspace->m_id].box;
+    phase.next("grid:render:active_cell");
+    const auto active_it = start_workspace != nullptr
+        ? overview_layout.find(start_workspace->m_id)
+        : overview_layout.end();
+    if (active_it != overview_layout.end()) {
+        const CBox& ws_box = active_it->second.box;
+        const CBox& render_box = active_it->second.render_box;
         // make sure box is not empty
         if (ws_box.width > 0.01 && ws_box.height > 0.01) {
-            // renderModif translation used by renderWorkspace is weird so need
-            // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
-            CBox render_box = {{ws_box.pos() / scale->value()}, ws_box.size()};
-            if (monitor->m_transform % 2 == 1)
-                std::swap(render_box.w, render_box.h);
-
-            const Config::CGradientValueData border_col =
-                monitor->m_activeWorkspace->m_id == start_workspace->m_id ? *ACTIVECOL
-                                                                          : *INACTIVECOL;
-            CBox border_box = ws_box;
-
-            CBorderPassElement::SBorderData data;
-            data.box = border_box;
-            data.grad1 = border_col;
-            data.borderSize = BORDERSIZE;
-
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                start_workspace,
-                time,
-                render_box
-            );
-            g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+            render_cell(monitor, start_workspace, time, render_box);
+            queue_border(ws_box, true);
         }
     }
 
+    // One overlay element holding every cell border, each its own renderBorder, below the
+    // dragged window
+    flush_borders();
+    spread.render(*this, monitor, time);
+
+    phase.next("grid:render:drag_window");
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
     if (cursor_view == nullptr)
         return;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <unordered_map>
 #include <unordered_set>
@@ -21,6 +22,9 @@ class HTLayoutGrid: public HTLayoutBase {
     // Survives workspace destruction so a slot stays sticky for an empty ws.
     std::unordered_map<WORKSPACEID, HTGridSlot> ws_slot_cache;
     std::unordered_map<long long, WORKSPACEID> slot_ws_cache;
+    // Neighbours of every slotted workspace with grid:loop and grid:loop_layers applied.
+    // Rebuilt together with the slot caches, so navigating is a single lookup
+    std::unordered_map<WORKSPACEID, std::array<WORKSPACEID, HT_DIR_COUNT>> nav_graph;
 
     static long long pack_slot(int layer, int x, int y);
 
@@ -32,6 +36,8 @@ class HTLayoutGrid: public HTLayoutBase {
 
     virtual CBox calculate_ws_box(int x, int y, HTViewStage stage);
 
+    virtual bool is_animating();
+
     virtual void close_open_lerp(float perc);
     virtual void on_show(CallbackFun on_complete);
     virtual void on_hide(CallbackFun on_complete);
@@ -40,6 +46,8 @@ class HTLayoutGrid: public HTLayoutBase {
     virtual WORKSPACEID on_move_swipe_end();
 
     virtual WORKSPACEID get_ws_id_in_direction(int x, int y, std::string& direction);
+    virtual WORKSPACEID get_neighbour(WORKSPACEID ws_id, HTDirection direction);
+    virtual int get_ws_layer(WORKSPACEID ws_id);
 
     virtual bool should_render_window(PHLWINDOW window);
     virtual float drag_window_scale();
@@ -49,6 +57,8 @@ class HTLayoutGrid: public HTLayoutBase {
 
     void refresh_workspace_cache(const std::unordered_set<WORKSPACEID>& extra_off_limits = {});
     WORKSPACEID slot_workspace(int layer, int x, int y);
+    // Rebuild nav_graph from the current slot caches
+    void build_nav_graph();
 
     const std::unordered_map<WORKSPACEID, HTGridSlot>& cache() const { return ws_slot_cache; }
 };
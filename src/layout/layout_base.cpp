@@ -1,21 +1,61 @@
+#include <algorithm>
 #include <any>
 #include <sstream>
 
 #define private public
+#include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/desktop/rule/layerRule/LayerRuleApplicator.hpp>
+#include <hyprland/src/desktop/rule/windowRule/WindowRuleApplicator.hpp>
+#include <hyprland/src/desktop/view/LayerSurface.hpp>
+#include <hyprland/src/desktop/view/Popup.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
+#include <hyprland/src/protocols/core/Compositor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/render/Renderer.hpp>
 #include <hyprland/src/render/pass/ClearPassElement.hpp>
 #undef private
 
+#include "../cell_cache.hpp"
+#include "../config.hpp"
 #include "../globals.hpp"
 #include "../pass/pass_element.hpp"
+#include "../render.hpp"
+#include "../search.hpp"
 #include "../types.hpp"
 #include "layout_base.hpp"
 
+HTDirection parse_direction(const std::string& direction) {
+    if (direction == "up")
+        return HT_DIR_UP;
+    if (direction == "down")
+        return HT_DIR_DOWN;
+    if (direction == "left")
+        return HT_DIR_LEFT;
+    if (direction == "right")
+        return HT_DIR_RIGHT;
+    if (direction == "in")
+        return HT_DIR_IN;
+    if (direction == "out")
+        return HT_DIR_OUT;
+    return HT_DIR_COUNT;
+}
+
 HTLayoutBase::HTLayoutBase(VIEWID new_view_id) : view_id(new_view_id) {
-    ;
+    border_batch.search_text_cache = &search_text_cache;
+    cell_composite_batch.cell_cache = &cell_cache;
+}
+
+HTLayoutBase::~HTLayoutBase() {
+    // GL objects of this overview, freed while the compositor's GL context still exists
+    g_pHyprRenderer->makeEGLCurrent();
+    search_text_cache.texture.reset();
+    shared_layers_cache.release();
+    cell_cache.release();
 }
 
 void HTLayoutBase::on_move_swipe(Vector2D delta) {
@@ -41,10 +81,415 @@ WORKSPACEID HTLayoutBase::get_ws_id_in_direction(int x, int y, std::string& dire
     return get_ws_id_from_xy(x, y);
 }
 
+WORKSPACEID HTLayoutBase::get_neighbour(WORKSPACEID ws_id, HTDirection direction) {
+    static const std::string DIRECTION_NAMES[] = {"up", "down", "left", "right"};
+    if (direction > HT_DIR_RIGHT)
+        return WORKSPACE_INVALID;
+
+    auto it = overview_layout.find(ws_id);
+    if (it == overview_layout.end()) {
+        build_overview_layout(HT_VIEW_CLOSED);
+        it = overview_layout.find(ws_id);
+        if (it == overview_layout.end())
+            return WORKSPACE_INVALID;
+    }
+    std::string direction_name = DIRECTION_NAMES[direction];
+    return get_ws_id_in_direction(it->second.x, it->second.y, direction_name);
+}
+
+int HTLayoutBase::get_ws_layer(WORKSPACEID ws_id) {
+    return layer;
+}
+
 bool HTLayoutBase::on_mouse_axis(double delta) {
     return false;
 }
 
+bool HTLayoutBase::is_animating() {
+    return false;
+}
+
+void HTLayoutBase::schedule_next_frame(PHLMONITOR monitor) {
+    const bool own_frame = damaged_self;
+    damaged_self = false;
+
+    const bool dragging = g_layoutManager->dragController()->target() != nullptr;
+    const bool swiping = ht_manager->swipe_state != HTManager::HT_SWIPE_NONE;
+    if (own_frame && !is_animating() && !spread.is_animating() && !dragging && !swiping)
+        return;
+
+    damaged_self = true;
+    damage_monitor(monitor);
+}
+
+void HTLayoutBase::update_occlusion() {
+    occluded_windows.clear();
+
+    // The dragged window is drawn at the cursor, so it covers nothing in its cell
+    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
+    const PHLWINDOW dragged_window = target != nullptr ? target->window() : nullptr;
+
+    // Hyprland stacks fullscreen windows over floating ones over tiled ones, each group in
+    // m_windows order, so walk the groups top down and m_windows back to front. Pinned windows
+    // and ones opened over a fullscreen window stay above it
+    enum {
+        OVER_FULLSCREEN,
+        FULLSCREEN,
+        FLOATING,
+        TILED,
+        GROUP_COUNT,
+    };
+    const auto& windows = g_pCompositor->m_windows;
+    for (const auto& [ws_id, cell] : overview_layout) {
+        occlusion_covered.clear();
+        for (int group = OVER_FULLSCREEN; group < GROUP_COUNT; group++) {
+            for (auto it = windows.rbegin(); it != windows.rend(); it++) {
+                const PHLWINDOW& window = *it;
+                if (window == nullptr || window == dragged_window || !window->m_isMapped
+                    || window->isHidden() || window->workspaceID() != ws_id)
+                    continue;
+                int window_group = TILED;
+                if (window->isFullscreen())
+                    window_group = FULLSCREEN;
+                else if (window->m_isFloating)
+                    window_group = window->m_pinned || window->m_createdOverFullscreen
+                        ? OVER_FULLSCREEN
+                        : FLOATING;
+                if (window_group != group)
+                    continue;
+
+                const CBox box = window->getWindowMainSurfaceBox();
+                if (!occlusion_covered.empty()
+                    && CRegion {box}.subtract(occlusion_covered).empty()) {
+                    pool_push(occluded_windows, window.get());
+                    continue;
+                }
+                // Rounded corners let what is below show through, only count the inner box
+                if (window->opaque())
+                    occlusion_covered.add(box.copy().expand(-window->rounding()));
+            }
+        }
+    }
+}
+
+bool HTLayoutBase::is_occluded(PHLWINDOW window) const {
+    return std::ranges::find(occluded_windows, window.get()) != occluded_windows.end();
+}
+
+PHLWINDOW HTLayoutBase::get_solo_window(PHLWORKSPACE workspace) const {
+    if (workspace == nullptr || !workspace->m_hasFullscreenWindow
+        || workspace->m_fullscreenMode != FSMODE_FULLSCREEN)
+        return nullptr;
+
+    const PHLWINDOW fullscreen_window = workspace->getFullscreenWindow();
+    if (fullscreen_window == nullptr || !fullscreen_window->m_isMapped
+        || fullscreen_window->isHidden() || !fullscreen_window->opaque())
+        return nullptr;
+    // Going in or out of fullscreen, the rest of the workspace is still visible around it
+    if (fullscreen_window->m_realPosition->isBeingAnimated()
+        || fullscreen_window->m_realSize->isBeingAnimated())
+        return nullptr;
+
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || window == fullscreen_window || !window->m_isMapped
+            || window->isHidden() || window->workspaceID() != workspace->m_id)
+            continue;
+        if (!is_occluded(window))
+            return nullptr;
+    }
+    return fullscreen_window;
+}
+
+// Whether renderWorkspace would draw layer as nothing but its texture at its geometry. Rules,
+// subsurfaces, popups and animations all need renderWorkspace's own layer path
+static bool is_plain_layer(const PHLLS& layer) {
+    const auto resource = layer->m_surface ? layer->m_surface->resource() : nullptr;
+    if (resource == nullptr || resource->m_current.texture == nullptr)
+        return false;
+    if (layer->m_fadingOut || layer->m_alpha->isBeingAnimated() || layer->m_alpha->value() < 1.f)
+        return false;
+    if (layer->m_realPosition->isBeingAnimated() || layer->m_realSize->isBeingAnimated())
+        return false;
+    if (!resource->m_subsurfaces.empty())
+        return false;
+    if (layer->m_popupHead != nullptr && !layer->m_popupHead->m_children.empty())
+        return false;
+    const auto& rules = layer->m_ruleApplicator;
+    return !rules->blur().valueOrDefault() && !rules->blurPopups().valueOrDefault()
+        && !rules->xray().valueOrDefault() && !rules->dimAround().valueOrDefault()
+        && !rules->ignoreAlpha().hasValue();
+}
+
+void HTLayoutBase::add_shared_layers(PHLMONITOR monitor) {
+    shared_layers = false;
+
+    HTPassElement::SData& batch = shared_layers_batch;
+    batch.layer_cells.clear();
+    batch.layer_textures.clear();
+    batch.layer_cache = &shared_layers_cache;
+
+    // The cache is drawn through the monitor's projection, so it only lines up with the
+    // cells' pixel space when the monitor is not rotated
+    if (monitor->m_transform != WL_OUTPUT_TRANSFORM_NORMAL)
+        return;
+
+    const CBox mon_box = {{0, 0}, monitor->m_pixelSize};
+    double cache_scale = 0.;
+    for (const auto& [ws_id, cell] : overview_layout) {
+        if (cell.box.width < 0.01 || cell.box.height < 0.01)
+            continue;
+        if (cell.box.intersection(mon_box).empty())
+            continue;
+        // Drawn as their solo window, nothing of the layers shows
+        if (get_solo_window(g_pCompositor->getWorkspaceByID(ws_id)) != nullptr)
+            continue;
+        pool_push(batch.layer_cells, cell.box);
+        cache_scale = std::max(cache_scale, cell.local_scale);
+    }
+    if (batch.layer_cells.empty() || cache_scale <= 0.)
+        return;
+
+    for (const auto layer_idx :
+         {ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND, ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM}) {
+        for (const PHLLSREF& layer_ref : monitor->m_layerSurfaceLayers[layer_idx]) {
+            const PHLLS layer = layer_ref.lock();
+            if (layer == nullptr || !layer->m_mapped)
+                continue;
+            // Any layer that isn't plain leaves both layers to renderWorkspace in every cell
+            if (!is_plain_layer(layer))
+                return;
+            const auto resource = layer->m_surface->resource();
+
+            const CBox box = {
+                (layer->m_geometry.pos() - monitor->m_position) * monitor->m_scale * cache_scale,
+                layer->m_geometry.size() * monitor->m_scale * cache_scale,
+            };
+            pool_push(
+                batch.layer_textures,
+                HTPassElement::SLayerTexture {resource->m_current.texture, box}
+            );
+        }
+    }
+    if (batch.layer_textures.empty())
+        return;
+
+    batch.layer_cache_size = monitor->m_pixelSize * cache_scale;
+    add_pass_element<HTPassElement>(HTPassElement::HT_PASS_SHARED_LAYERS, &batch);
+    shared_layers = true;
+}
+
+void HTLayoutBase::begin_cell_cache(PHLMONITOR monitor) {
+    const bool dragging = g_layoutManager->dragController()->target() != nullptr;
+    const bool swiping = ht_manager->swipe_state != HTManager::HT_SWIPE_NONE;
+    // The cache is drawn through the monitor's projection like the shared layers cache, and
+    // cells are only cached while they stay where they are
+    const bool enabled = HTConfig::value<Config::INTEGER>("cell_cache")
+        && monitor->m_transform == WL_OUTPUT_TRANSFORM_NORMAL && !is_animating()
+        && !spread.is_animating() && !dragging && !swiping && HTCellCache::watch_layers(monitor);
+
+    // Nothing was captured while the cache was off, and a resize reallocates it
+    if (!enabled || cell_cache_size != monitor->m_pixelSize) {
+        for (auto& [ws_id, cached] : cached_cells)
+            cached.valid = false;
+    }
+    cell_cache_enabled = enabled;
+    cell_cache_size = monitor->m_pixelSize;
+
+    // Borders follow focus without the windows committing
+    const PHLWINDOW focus = Desktop::focusState()->window();
+    if (focus != cell_cache_focus.lock()) {
+        cell_cache_focus = focus;
+        HTCellCache::invalidate();
+    }
+}
+
+// Whether inner lies entirely within outer
+static bool box_contains(const CBox& outer, const CBox& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.w <= outer.x + outer.w
+        && inner.y + inner.h <= outer.y + outer.h;
+}
+
+static uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+bool HTLayoutBase::is_cacheable(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    uint64_t& signature
+) const {
+    if (workspace == nullptr || get_solo_window(workspace) != nullptr)
+        return false;
+    // Live blur samples whatever is under the window in the framebuffer it draws into
+    const HTWorkspace* cell = get_cell(workspace->m_id);
+    if (cell == nullptr || cell_blur_mode(cell->local_scale) == HT_CELL_BLUR_LIVE)
+        return false;
+
+    for (const PHLWINDOWREF& window_ref : g_pCompositor->m_windowsFadingOut) {
+        const PHLWINDOW window = window_ref.lock();
+        if (window != nullptr && window->workspaceID() == workspace->m_id)
+            return false;
+    }
+
+    const CBox mon_box = monitor->logicalBox();
+    signature = 0;
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || !window->m_isMapped || window->workspaceID() != workspace->m_id)
+            continue;
+        if (window->m_realPosition->isBeingAnimated() || window->m_realSize->isBeingAnimated()
+            || window->m_alpha->isBeingAnimated()
+            || window->m_activeInactiveAlpha->isBeingAnimated()
+            || window->m_borderFadeAnimationProgress->isBeingAnimated()
+            || window->m_borderAngleAnimationProgress->isBeingAnimated())
+            return false;
+        // Popup surfaces are not watched
+        if (window->m_popupHead != nullptr && !window->m_popupHead->m_children.empty())
+            return false;
+        // What a window draws past the workspace would land in a neighbouring cached cell
+        if (!window->isHidden() && !box_contains(mon_box, window->getFullWindowBoundingBox()))
+            return false;
+
+        const Vector2D pos = window->m_realPosition->value();
+        const Vector2D size = window->m_realSize->value();
+        signature = hash_combine(signature, (uintptr_t)window.get());
+        signature = hash_combine(signature, std::hash<double> {}(pos.x));
+        signature = hash_combine(signature, std::hash<double> {}(pos.y));
+        signature = hash_combine(signature, std::hash<double> {}(size.x));
+        signature = hash_combine(signature, std::hash<double> {}(size.y));
+        signature = hash_combine(signature, window->isHidden() | window->isFullscreen() << 1);
+    }
+    return true;
+}
+
+bool HTLayoutBase::queue_cached_cell(PHLMONITOR monitor, PHLWORKSPACE workspace) {
+    uint64_t signature = 0;
+    if (!cell_cache_enabled || !is_cacheable(monitor, workspace, signature)) {
+        end_capture_run();
+        return false;
+    }
+    const HTWorkspace* cell = get_cell(workspace->m_id);
+    const uint64_t generation = HTCellCache::generation(workspace->m_id);
+    const auto [it, inserted] = cached_cells.try_emplace(workspace->m_id);
+    if (inserted)
+        ht_alloc_stats.storage_growths++;
+
+    SCachedCell& cached = it->second;
+    if (cached.valid && cached.generation == generation && cached.signature == signature
+        && cached.box == cell->box) {
+        pool_push(cell_composite_batch.cell_boxes, cell->box);
+#ifdef HT_RENDER_RECORDER
+        ht_render_recorder.current.cached_cells++;
+#endif
+        return true;
+    }
+
+    // A frame only redraws its damage, a cell it does not cover would be captured in part
+    cached.valid = false;
+    if (!CRegion {cell->box}.subtract(g_pHyprOpenGL->m_renderData.damage).empty()) {
+        end_capture_run();
+        return false;
+    }
+
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window != nullptr && window->m_isMapped && window->workspaceID() == workspace->m_id)
+            HTCellCache::watch_window(window);
+    }
+    if (capture_run == nullptr) {
+        if (cell_capture_used == cell_capture_batches.size()) {
+            ht_alloc_stats.storage_growths++;
+            cell_capture_batches.emplace_back();
+        }
+        capture_run = &cell_capture_batches[cell_capture_used++];
+        capture_run->cell_boxes.clear();
+        capture_run->cell_cache = &cell_cache;
+        add_pass_element<HTPassElement>(HTPassElement::HT_PASS_CELL_CAPTURE_BEGIN, capture_run);
+    }
+    pool_push(capture_run->cell_boxes, cell->box);
+    // Captured cells reach the monitor through the composite as well
+    pool_push(cell_composite_batch.cell_boxes, cell->box);
+    cached = {cell->box, generation, signature, true};
+    return false;
+}
+
+void HTLayoutBase::end_capture_run() {
+    if (capture_run == nullptr)
+        return;
+    add_pass_element<HTPassElement>(HTPassElement::HT_PASS_CELL_CAPTURE_END, capture_run);
+    capture_run = nullptr;
+}
+
+void HTLayoutBase::render_cell(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& render_box
+) {
+    if (queue_cached_cell(monitor, workspace))
+        return;
+
+    if (const PHLWINDOW solo_window = get_solo_window(workspace)) {
+        const CBox window_box = get_global_window_box(solo_window, workspace->m_id);
+        if (!window_box.empty()) {
+            render_window_at_box(solo_window, monitor, time, window_box, false);
+            return;
+        }
+    }
+    // Windows of this cell that would otherwise blur live behind themselves
+    const HTWorkspace* cell = workspace != nullptr ? get_cell(workspace->m_id) : nullptr;
+    const HTCellBlurMode blur_mode = cell_blur_mode(cell != nullptr ? cell->local_scale : 1.);
+    HTPassElement::SData* blur = nullptr;
+    if (blur_mode != HT_CELL_BLUR_LIVE && workspace != nullptr) {
+        if (cell_blur_used == cell_blur_batches.size()) {
+            ht_alloc_stats.storage_growths++;
+            cell_blur_batches.emplace_back();
+        }
+        blur = &cell_blur_batches[cell_blur_used];
+        blur->blur_windows.clear();
+        for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+            if (window == nullptr || !window->m_isMapped || window->isHidden()
+                || window->workspaceID() != workspace->m_id || is_occluded(window))
+                continue;
+            pool_push(blur->blur_windows, PHLWINDOWREF {window});
+        }
+        if (blur->blur_windows.empty())
+            blur = nullptr;
+        else
+            cell_blur_used++;
+    }
+#ifdef HT_RENDER_RECORDER
+    if (blur != nullptr)
+        ht_render_recorder.current.blur_skipped += blur->blur_windows.size();
+#endif
+
+    // renderWindow bakes whether a surface blurs into its pass element as it is queued, so
+    // turning blur off is applied around the queueing. Shared blur is read when the element
+    // draws, so it is switched by pass elements on either side of the cell
+    if (blur != nullptr && blur_mode == HT_CELL_BLUR_OFF) {
+        for (const PHLWINDOWREF& window : blur->blur_windows)
+            window->m_ruleApplicator->noBlur().set(true, Desktop::Types::PRIORITY_LAYOUT);
+    }
+    if (blur != nullptr && blur_mode == HT_CELL_BLUR_SHARED)
+        add_pass_element<HTPassElement>(HTPassElement::HT_PASS_CELL_BLUR_BEGIN, blur);
+
+    if (!shared_layers) {
+        render_workspace_original(monitor, workspace, time, render_box);
+    } else {
+        auto& layers = monitor->m_layerSurfaceLayers;
+        std::swap(layers[ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND], stashed_layers[0]);
+        std::swap(layers[ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM], stashed_layers[1]);
+        render_workspace_original(monitor, workspace, time, render_box);
+        std::swap(layers[ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND], stashed_layers[0]);
+        std::swap(layers[ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM], stashed_layers[1]);
+    }
+
+    if (blur != nullptr && blur_mode == HT_CELL_BLUR_OFF) {
+        for (const PHLWINDOWREF& window : blur->blur_windows)
+            window->m_ruleApplicator->noBlur().unset(Desktop::Types::PRIORITY_LAYOUT);
+    }
+    if (blur != nullptr && blur_mode == HT_CELL_BLUR_SHARED)
+        add_pass_element<HTPassElement>(HTPassElement::HT_PASS_CELL_BLUR_END, blur);
+}
+
 bool HTLayoutBase::should_manage_mouse() {
     return true;
 }
@@ -73,10 +518,126 @@ void HTLayoutBase::build_overview_layout(HTViewStage stage) {
     ;
 }
 
+void HTLayoutBase::begin_layout_update(PHLMONITOR monitor) {
+    layout_generation++;
+    layout_monitor_pos = monitor->m_position;
+    layout_monitor_size = monitor->m_transformedSize;
+    layout_monitor_scale = monitor->m_scale;
+    layout_monitor_transform = monitor->m_transform;
+}
+
+void HTLayoutBase::update_layout_ws(
+    WORKSPACEID ws_id,
+    int x,
+    int y,
+    const CBox& box,
+    double render_scale
+) {
+    const auto [it, inserted] = overview_layout.try_emplace(ws_id);
+    if (inserted)
+        ht_alloc_stats.layout_nodes++;
+
+    HTWorkspace& ws = it->second;
+    ws.x = x;
+    ws.y = y;
+    ws.box = box;
+    ws.generation = layout_generation;
+
+    ws.monitor_scale = layout_monitor_scale;
+    ws.local_scale = layout_monitor_size.x > 0 ? box.w / layout_monitor_size.x : 0.;
+    ws.global_origin = box.pos() / layout_monitor_scale + layout_monitor_pos;
+
+    // renderModif translation used by renderWorkspace is weird so need
+    // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
+    if (render_scale <= 0.)
+        render_scale = ws.local_scale;
+    ws.render_box = {render_scale > 0. ? box.pos() / render_scale : Vector2D {}, box.size()};
+    if (layout_monitor_transform % 2 == 1)
+        std::swap(ws.render_box.w, ws.render_box.h);
+}
+
+void HTLayoutBase::end_layout_update() {
+    std::erase_if(overview_layout, [this](const auto& entry) {
+        return entry.second.generation != layout_generation;
+    });
+}
+
+void HTLayoutBase::queue_border(const CBox& box, bool active) {
+    pool_push(border_batch.borders, HTPassElement::SBorder {box, active});
+}
+
+void HTLayoutBase::flush_borders() {
+    if (borders_flushed)
+        return;
+    borders_flushed = true;
+    end_capture_run();
+    if (!cell_composite_batch.cell_boxes.empty())
+        add_pass_element<HTPassElement>(
+            HTPassElement::HT_PASS_CELL_COMPOSITE,
+            &cell_composite_batch
+        );
+    queue_search_matches();
+    add_pass_element<HTPassElement>(HTPassElement::HT_PASS_OVERLAY, &border_batch);
+}
+
+void HTLayoutBase::queue_search_matches() {
+    if (HTSearch::query().empty())
+        return;
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    border_batch.highlight =
+        CHyprColor {HTConfig::value<Config::INTEGER>("search:highlight_color")};
+    border_batch.search_text = HTSearch::query();
+    const PHLWINDOW selected = HTSearch::selected();
+    for (const PHLWINDOW& window : HTSearch::matches()) {
+        if (get_cell(window->workspaceID()) == nullptr)
+            continue;
+        const CBox global_box = get_global_window_box(window, window->workspaceID());
+        if (global_box.empty())
+            continue;
+        const CBox box = {
+            (global_box.pos() - monitor->m_position) * monitor->m_scale,
+            global_box.size() * monitor->m_scale
+        };
+        pool_push(border_batch.highlight_boxes, box);
+        if (window == selected)
+            queue_border(box, true);
+    }
+}
+
+void HTLayoutBase::add_background(const CBox& box) {
+    underlay_batch.background_boxes.clear();
+    pool_push(underlay_batch.background_boxes, box);
+    underlay_batch.background = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
+    underlay_batch.precompute_blur =
+        HTConfig::value<Config::INTEGER>("cell_blur") != HT_CELL_BLUR_OFF;
+    add_pass_element<HTPassElement>(HTPassElement::HT_PASS_UNDERLAY, &underlay_batch);
+}
+
 void HTLayoutBase::render() {
+    begin_overview_frame();
+
+    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
+    static auto PINACTIVECOL =
+        CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
+
+    borders_flushed = false;
+    border_batch.borders.clear();
+    border_batch.highlight_boxes.clear();
+    border_batch.search_text.clear();
+    cell_blur_used = 0;
+    cell_capture_used = 0;
+    capture_run = nullptr;
+    cell_composite_batch.cell_boxes.clear();
+    border_batch.active_grad = *(Config::CGradientValueData*)(PACTIVECOL.ptr());
+    border_batch.inactive_grad = *(Config::CGradientValueData*)(PINACTIVECOL.ptr());
+    border_batch.border_size = HTConfig::value<Config::FLOAT>("border_size");
+
     CClearPassElement::SClearData data;
     data.color = CHyprColor {0};
-    g_pHyprRenderer->m_renderPass.add(makeUnique<CClearPassElement>(data));
+    add_pass_element<CClearPassElement>(data);
 }
 
 const std::string CLEAR_PASS_ELEMENT_NAME = "CClearPassElement";
@@ -88,7 +649,9 @@ void HTLayoutBase::post_render() {
         first = false;
         return res;
     });
-    g_pHyprRenderer->m_renderPass.add(makeUnique<HTPassElement>());
+    // Also disables simplification for the whole pass
+    flush_borders();
+    end_overview_frame();
     // g_pHyprOpenGL->setDamage(CRegion {CBox {0, 0, INT32_MAX, INT32_MAX}});
 }
 
@@ -148,60 +711,47 @@ CBox HTLayoutBase::get_global_window_box(PHLWINDOW window, WORKSPACEID workspace
 }
 
 CBox HTLayoutBase::get_global_ws_box(WORKSPACEID workspace_id) {
-    const CBox scaled_ws_box = overview_layout[workspace_id].box;
+    const auto it = overview_layout.find(workspace_id);
+    if (it == overview_layout.end())
+        return {};
+    const CBox scaled_ws_box = it->second.box;
     const Vector2D top_left = local_ws_scaled_to_global(scaled_ws_box.pos(), workspace_id);
     const Vector2D bottom_right =
         local_ws_scaled_to_global(scaled_ws_box.pos() + scaled_ws_box.size(), workspace_id);
     return {top_left, bottom_right - top_left};
 }
 
-Vector2D HTLayoutBase::global_to_local_ws_unscaled(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
+const HTLayoutBase::HTWorkspace* HTLayoutBase::get_cell(WORKSPACEID workspace_id) const {
+    const auto it = overview_layout.find(workspace_id);
+    if (it == overview_layout.end() || it->second.box.empty() || it->second.local_scale <= 0.)
+        return nullptr;
+    return &it->second;
+}
 
-    CBox workspace_box = overview_layout[workspace_id].box;
-    if (workspace_box.empty())
+Vector2D HTLayoutBase::global_to_local_ws_unscaled(Vector2D pos, WORKSPACEID workspace_id) {
+    const HTWorkspace* cell = get_cell(workspace_id);
+    if (cell == nullptr)
         return {};
-    pos -= monitor->m_position;
-    pos *= monitor->m_scale;
-    pos -= workspace_box.pos();
-    pos /= monitor->m_scale;
-    pos /= workspace_box.w / monitor->m_transformedSize.x;
-    return pos;
+    return (pos - cell->global_origin) / cell->local_scale;
 }
 
 Vector2D HTLayoutBase::global_to_local_ws_scaled(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
+    const HTWorkspace* cell = get_cell(workspace_id);
+    if (cell == nullptr)
         return {};
-
-    pos = global_to_local_ws_unscaled(pos, workspace_id);
-    pos *= monitor->m_scale;
-    return pos;
+    return (pos - cell->global_origin) * (cell->monitor_scale / cell->local_scale);
 }
 
 Vector2D HTLayoutBase::local_ws_unscaled_to_global(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
-
-    CBox workspace_box = overview_layout[workspace_id].box;
-    if (workspace_box.empty())
+    const HTWorkspace* cell = get_cell(workspace_id);
+    if (cell == nullptr)
         return {};
-    pos *= workspace_box.w / monitor->m_transformedSize.x;
-    pos *= monitor->m_scale;
-    pos += workspace_box.pos();
-    pos /= monitor->m_scale;
-    pos += monitor->m_position;
-    return pos;
+    return pos * cell->local_scale + cell->global_origin;
 }
 
 Vector2D HTLayoutBase::local_ws_scaled_to_global(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
+    const HTWorkspace* cell = get_cell(workspace_id);
+    if (cell == nullptr)
         return {};
-
-    pos /= monitor->m_scale;
-    return local_ws_unscaled_to_global(pos, workspace_id);
+    return pos * (cell->local_scale / cell->monitor_scale) + cell->global_origin;
 }
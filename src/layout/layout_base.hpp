@@ -3,10 +3,16 @@
 #include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
 #include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Region.hpp>
+#include <array>
+#include <deque>
 #include <unordered_map>
 
+#include "../pass/pass_element.hpp"
 #include "../types.hpp"
+#include "spread.hpp"
 
 enum HTViewStage {
     HT_VIEW_ANIMATING,
@@ -14,31 +20,160 @@ enum HTViewStage {
     HT_VIEW_CLOSED,
 };
 
+enum HTDirection {
+    HT_DIR_UP,
+    HT_DIR_DOWN,
+    HT_DIR_LEFT,
+    HT_DIR_RIGHT,
+    // in and out move across layers
+    HT_DIR_IN,
+    HT_DIR_OUT,
+    HT_DIR_COUNT,
+};
+
+// Returns HT_DIR_COUNT for anything that is not a direction
+HTDirection parse_direction(const std::string& direction);
+
 class HTLayoutBase {
   protected:
     // Same as monitor_id of the parent view
     VIEWID view_id;
 
+    // Rebuild overview_layout in place, reusing its nodes: entries not updated between
+    // begin and end are dropped, so a steady-state rebuild does not allocate
+    uint64_t layout_generation = 0;
+    // Monitor geometry captured by begin_layout_update for the cell transforms
+    Vector2D layout_monitor_pos;
+    Vector2D layout_monitor_size;
+    double layout_monitor_scale = 1.;
+    int layout_monitor_transform = 0;
+    void begin_layout_update(PHLMONITOR monitor);
+    // render_scale is the scale renderWorkspace is given the cell at, 0 to derive it from box
+    void
+    update_layout_ws(WORKSPACEID ws_id, int x, int y, const CBox& box, double render_scale = 0.);
+    void end_layout_update();
+
+    // Cell borders of the current frame, drawn by a single overlay HTPassElement after every
+    // cell, so a cell's contents overflowing its box are drawn under neighbouring borders
+    HTPassElement::SData border_batch;
+    HTPassElement::SSearchText search_text_cache;
+    bool borders_flushed = false;
+    void queue_border(const CBox& box, bool active);
+    // Add the cell composite and the batched borders to the render pass. Anything added
+    // afterwards is drawn on top
+    void flush_borders();
+    // Highlight the search matches laid out in this overview, the selected one with a border
+    void queue_search_matches();
+    // Add the underlay HTPassElement, filling box with bg_color
+    HTPassElement::SData underlay_batch;
+    void add_background(const CBox& box);
+
+    // Whether the last frame damaged the monitor itself, so the frame being rendered is ours
+    bool damaged_self = false;
+    // Damage the monitor for another frame unless the overview is static: nothing animating,
+    // dragged or swiped. A frame caused by outside damage (a client commit) gets one full
+    // follow-up, since that damage is where the window is, not where its cell is drawn
+    void schedule_next_frame(PHLMONITOR monitor);
+
+    // Windows of laid out workspaces that are entirely covered by opaque windows stacked above
+    // them. Rebuilt by update_occlusion each frame, kept as a vector so that does not allocate
+    std::vector<const Desktop::View::CWindow*> occluded_windows;
+    CRegion occlusion_covered;
+    void update_occlusion();
+    bool is_occluded(PHLWINDOW window) const;
+
+    // Background and bottom layer-shell surfaces look the same in every cell. When they are
+    // plain surfaces, add_shared_layers draws them once for all cells at the largest cell's
+    // size, and render_cell keeps them off the monitor while each cell renders
+    CFramebuffer shared_layers_cache;
+    HTPassElement::SData shared_layers_batch;
+    std::array<std::vector<PHLLSREF>, 2> stashed_layers;
+    bool shared_layers = false;
+    void add_shared_layers(PHLMONITOR monitor);
+
+    // One per cell that switches its windows' blur this frame. A deque so queued elements
+    // keep pointing at their entry while later cells grow it
+    std::deque<HTPassElement::SData> cell_blur_batches;
+    size_t cell_blur_used = 0;
+
+    // Cells whose contents did not change since they were drawn are copied out of
+    // cell_cache by one composite element instead of rendering their windows again. Cells
+    // that can be cached but changed are captured into it by capture runs, an element pair
+    // around consecutive cells. See HTCellCache for what counts as a change
+    struct SCachedCell {
+        CBox box;
+        uint64_t generation = 0;
+        uint64_t signature = 0;
+        bool valid = false;
+    };
+    CFramebuffer cell_cache;
+    std::unordered_map<WORKSPACEID, SCachedCell> cached_cells;
+    // Only set for frames where nothing moves, see begin_cell_cache
+    bool cell_cache_enabled = false;
+    Vector2D cell_cache_size;
+    PHLWINDOWREF cell_cache_focus;
+    HTPassElement::SData cell_composite_batch;
+    // Like cell_blur_batches, one per capture run. capture_run is the one still open
+    std::deque<HTPassElement::SData> cell_capture_batches;
+    size_t cell_capture_used = 0;
+    HTPassElement::SData* capture_run = nullptr;
+    void begin_cell_cache(PHLMONITOR monitor);
+    // Whether workspace's cell can be kept in the cache, and the signature of its windows'
+    // geometry, which changes when one moves without committing a new buffer
+    bool is_cacheable(PHLMONITOR monitor, PHLWORKSPACE workspace, uint64_t& signature) const;
+    // Returns true when the cell is drawn from the cache. Otherwise the cell is added to the
+    // open capture run if it can be cached, or the run is ended so the cell is drawn live
+    bool queue_cached_cell(PHLMONITOR monitor, PHLWORKSPACE workspace);
+    void end_capture_run();
+
+    // The opaque fullscreen window that hides everything else on workspace, if there is one.
+    // Only valid after update_occlusion
+    PHLWINDOW get_solo_window(PHLWORKSPACE workspace) const;
+    // Render workspace into render_box, or just its solo window scaled into the cell: layers,
+    // decorations and covered windows of a fullscreen workspace would be drawn for nothing
+    void render_cell(
+        PHLMONITOR monitor,
+        PHLWORKSPACE workspace,
+        const Time::steady_tp& time,
+        const CBox& render_box
+    );
+
   public:
     using CallbackFun = Hyprutils::Animation::CBaseAnimatedVariable::CallbackFun;
 
     HTLayoutBase(VIEWID new_view_id);
-    virtual ~HTLayoutBase() = default;
+    virtual ~HTLayoutBase();
 
     VIEWID get_view_id() const { return view_id; }
 
     virtual std::string layout_name() = 0;
 
     int layer = 0;
+    // Drawn by render() on top of the cells while active
+    HTSpread spread;
+
     struct HTWorkspace {
         int x;
         int y;
         CBox box;
+        // Last layout update that touched this entry
+        uint64_t generation = 0;
+
+        // Precomputed when the entry is updated, so conversions need no lookups:
+        // global = local_unscaled * local_scale + global_origin
+        double local_scale = 0.;
+        Vector2D global_origin;
+        double monitor_scale = 1.;
+        // Geometry handed to renderWorkspace for this cell
+        CBox render_box;
     };
 
     virtual CBox calculate_ws_box(int x, int y, HTViewStage stage) = 0;
     std::unordered_map<WORKSPACEID, HTWorkspace> overview_layout;
 
+    // Whether any of the layout's animated variables is still moving
+    virtual bool is_animating();
+
     // Warp the show/hide animations to perc (from closed to open)
     virtual void close_open_lerp(float perc) = 0;
     virtual void on_show(CallbackFun on_complete = nullptr) = 0;
@@ -51,6 +186,10 @@ class HTLayoutBase {
 
     // Get the workspace up/down left/right relative to the workspace at (x, y)
     virtual WORKSPACEID get_ws_id_in_direction(int x, int y, std::string& direction);
+    // Get the workspace in direction of ws_id, as the layout would be when closed
+    virtual WORKSPACEID get_neighbour(WORKSPACEID ws_id, HTDirection direction);
+    // The layer ws_id lives on, for layouts that have layers
+    virtual int get_ws_layer(WORKSPACEID ws_id);
 
     // Return true if should cancel
     virtual bool on_mouse_axis(double delta);
@@ -78,7 +217,11 @@ class HTLayoutBase {
     std::pair<int, int> get_current_ws_xy();
     CBox get_global_window_box(PHLWINDOW window, WORKSPACEID workspace_id);
     CBox get_global_ws_box(WORKSPACEID workspace_id);
+    // The laid out cell of workspace_id, nullptr if it has none or it is empty
+    const HTWorkspace* get_cell(WORKSPACEID workspace_id) const;
 
+    // Conversions use the transform cached in overview_layout, so they are only as fresh as
+    // the last build_overview_layout
     Vector2D global_to_local_ws_scaled(Vector2D pos, WORKSPACEID workspace_id);
     Vector2D global_to_local_ws_unscaled(Vector2D pos, WORKSPACEID workspace_id);
     Vector2D local_ws_scaled_to_global(Vector2D pos, WORKSPACEID workspace_id);
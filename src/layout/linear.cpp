@@ -10,7 +10,6 @@
 #include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
-#include <hyprland/src/render/pass/BorderPassElement.hpp>
 #include <hyprland/src/render/pass/RectPassElement.hpp>
 #include <hyprutils/math/Box.hpp>
 #include <hyprutils/utils/ScopeGuard.hpp>
@@ -19,6 +18,8 @@
 #include "../config.hpp"
 #include "../globals.hpp"
 #include "../render.hpp"
+#include "../snapshot.hpp"
+#include "../trace.hpp"
 #include "layout_base.hpp"
 
 using Hyprutils::Utils::CScopeGuard;
@@ -49,6 +50,8 @@ HTLayoutLinear::HTLayoutLinear(VIEWID new_view_id) : HTLayoutBase(new_view_id) {
         anim_tree->getAnimationPropertyConfig("fadeDim"),
         AVARDAMAGE_NONE
     );
+    // Snapshot cell boxes include the scroll, wherever it is changed from
+    scroll_offset->setUpdateCallback([](auto) { HTSnapshot::invalidate(); });
 
     init_position();
 }
@@ -131,6 +134,11 @@ void HTLayoutLinear::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun
     }
 }
 
+bool HTLayoutLinear::is_animating() {
+    return scroll_offset->isBeingAnimated() || view_offset->isBeingAnimated()
+        || blur_strength->isBeingAnimated() || dim_opacity->isBeingAnimated();
+}
+
 bool HTLayoutLinear::on_mouse_axis(double delta) {
     if (!should_manage_mouse())
         return false;
@@ -208,6 +216,8 @@ bool HTLayoutLinear::should_render_window(PHLWINDOW window) {
 
     if (rendering_standard_ws)
         return ori_result;
+    if (is_occluded(window))
+        return false;
 
     PHLWORKSPACE workspace = window->m_workspace;
     if (workspace == nullptr)
@@ -277,34 +287,26 @@ void HTLayoutLinear::build_overview_layout(HTViewStage stage) {
     if (monitor == nullptr)
         return;
 
-    overview_layout.clear();
-
-    std::vector<WORKSPACEID> monitor_workspaces;
-    for (PHLWORKSPACE workspace : g_pCompositor->getWorkspacesCopy()) {
-        if (workspace == nullptr)
-            continue;
-        if (workspace->m_monitor != monitor)
-            continue;
-        if (workspace->m_isSpecialWorkspace)
-            continue;
-        monitor_workspaces.push_back(workspace->m_id);
-    }
-    std::sort(monitor_workspaces.begin(), monitor_workspaces.end());
+    begin_layout_update(monitor);
 
-    WORKSPACEID big_id = monitor_workspaces.back();
-    while (g_pCompositor->getWorkspaceByID(big_id) != nullptr)
-        big_id++;
-    monitor_workspaces.push_back(big_id);
+    // Already sorted, followed by an empty slot for a new workspace
+    const auto& monitor_workspaces = ht_manager->get_monitor_workspaces(monitor->m_id);
+    for (const auto& [x, ws_id] : monitor_workspaces.ids | std::views::enumerate)
+        update_layout_ws(ws_id, x, 0, calculate_ws_box(x, 0, stage));
+    const int new_x = monitor_workspaces.ids.size();
+    update_layout_ws(monitor_workspaces.next_free_id, new_x, 0, calculate_ws_box(new_x, 0, stage));
 
-    for (const auto& [x, ws_id] : monitor_workspaces | std::views::enumerate) {
-        CBox ws_box = calculate_ws_box(x, 0, stage);
-        overview_layout[ws_id] = {x, 0, ws_box};
-    }
+    end_layout_update();
 }
 
 void HTLayoutLinear::render() {
+    HT_TRACE_SCOPE("linear:render");
     HTLayoutBase::render();
-    CScopeGuard x([this] { post_render(); });
+    CScopeGuard x([this] {
+        HT_TRACE_SCOPE("linear:render:post");
+        post_render();
+    });
+    HTTraceScope phase("linear:render:big_workspace");
 
     const PHTVIEW par_view = ht_manager->get_view_from_id(view_id);
     if (par_view == nullptr)
@@ -313,20 +315,14 @@ void HTLayoutLinear::render() {
     if (monitor == nullptr)
         return;
 
-    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-    static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
-
-    auto* const ACTIVECOL = (Config::CGradientValueData*)(PACTIVECOL.ptr());
-    auto* const INACTIVECOL = (Config::CGradientValueData*)(PINACTIVECOL.ptr());
-
-    const float BORDERSIZE = HTConfig::value<Config::FLOAT>("border_size");
     const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
 
     const auto time = Time::steadyNow();
 
 
-    g_pHyprRenderer->damageMonitor(monitor);
-    g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
+    schedule_next_frame(monitor);
+    if (HTConfig::value<Config::INTEGER>("cell_blur") != HT_CELL_BLUR_OFF)
+        g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
 
     // Do a dance with active workspaces: Hyprland will only properly render the
     // current active one so make the workspace active before rendering it, etc
@@ -354,13 +350,7 @@ void HTLayoutLinear::render() {
     // use pixel size for geometry
     CBox mon_box = {{0, 0}, monitor->m_pixelSize};
     // Render the current workspace on the screen
-    ((render_workspace_t)(render_workspace_hook->m_original))(
-        g_pHyprRenderer.get(),
-        monitor,
-        big_ws,
-        time,
-        mon_box
-    );
+    render_workspace_original(monitor, big_ws, time, mon_box);
 
     // add blur/dim over the original workspace
     CRectPassElement::SRectData blur_data;
@@ -368,7 +358,7 @@ void HTLayoutLinear::render() {
     blur_data.box = mon_box;
     blur_data.blur = (bool)HTConfig::value<Config::INTEGER>("linear:blur");
     blur_data.blurA = blur_strength->value();
-    g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(blur_data));
+    add_pass_element<CRectPassElement>(blur_data);
 
     g_pDesktopAnimationManager->startAnimation(
         start_workspace,
@@ -384,39 +374,26 @@ void HTLayoutLinear::render() {
         {(float)monitor->m_transformedSize.x, (float)HEIGHT}
     };
 
-    CRectPassElement::SRectData data;
-    data.color = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
-    data.box = view_box;
-    g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
+    add_background(view_box);
 
     build_overview_layout(HT_VIEW_ANIMATING);
+    update_occlusion();
+    add_shared_layers(monitor);
+    begin_cell_cache(monitor);
 
     CBox global_mon_box = {monitor->m_position, monitor->m_transformedSize};
+    phase.next("linear:render:cells");
     for (const auto& [ws_id, ws_layout] : overview_layout) {
         // Could be nullptr, in which we render only layers
         const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
 
-        // renderModif translation used by renderWorkspace is weird so need
-        // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
-        CBox render_box = {
-            {ws_layout.box.pos() / (ws_layout.box.w / monitor->m_transformedSize.x)},
-            ws_layout.box.size()
-        };
-        if (monitor->m_transform % 2 == 1)
-            std::swap(render_box.w, render_box.h);
+        const CBox& render_box = ws_layout.render_box;
 
         CBox global_box = {ws_layout.box.pos() + monitor->m_position, ws_layout.box.size()};
         if (global_box.intersection(global_mon_box).empty())
             continue;
 
-        const Config::CGradientValueData border_col = workspace == big_ws ? *ACTIVECOL : *INACTIVECOL;
-        CBox border_box = ws_layout.box;
-
-        CBorderPassElement::SBorderData data;
-        data.box = border_box;
-        data.grad1 = border_col;
-        data.borderSize = BORDERSIZE;
-        g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+        queue_border(ws_layout.box, workspace == big_ws);
 
         if (workspace != nullptr) {
             monitor->m_activeWorkspace = workspace;
@@ -428,13 +405,7 @@ void HTLayoutLinear::render() {
             );
             workspace->m_visible = true;
 
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
+            render_cell(monitor, workspace, time, render_box);
 
             g_pDesktopAnimationManager->startAnimation(
                 workspace,
@@ -445,13 +416,7 @@ void HTLayoutLinear::render() {
             workspace->m_visible = false;
         } else {
             // If pWorkspace is null, then just render the layers
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
+            render_cell(monitor, workspace, time, render_box);
         }
     }
 
@@ -464,6 +429,12 @@ void HTLayoutLinear::render() {
     );
     start_workspace->m_visible = true;
 
+    // One overlay element holding every cell border, each its own renderBorder, below the
+    // dragged window
+    flush_borders();
+    spread.render(*this, monitor, time);
+
+    phase.next("linear:render:drag_window");
     // Render dragged window at mouse cursor
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
     if (cursor_view == nullptr)
@@ -20,6 +20,8 @@ class HTLayoutLinear: public HTLayoutBase {
 
     virtual CBox calculate_ws_box(int x, int y, HTViewStage stage);
 
+    virtual bool is_animating();
+
     virtual void close_open_lerp(float perc);
     virtual void on_show(CallbackFun on_complete);
     virtual void on_hide(CallbackFun on_complete);
@@ -0,0 +1,194 @@
+#include "spread.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/config/shared/animation/AnimationTree.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/managers/animation/AnimationManager.hpp>
+
+#include "../config.hpp"
+#include "../pass/pass_element.hpp"
+#include "../render.hpp"
+#include "layout_base.hpp"
+
+// Opacity of bg_color over the overview with the spread fully open
+static constexpr float DIM_ALPHA = 0.85f;
+
+uint64_t HTSpread::generation = 1;
+
+HTSpread::HTSpread() {
+    auto& anim_tree = Config::animationTree();
+    g_pAnimationManager->createAnimation(
+        0.f,
+        perc,
+        anim_tree->getAnimationPropertyConfig("workspaces"),
+        AVARDAMAGE_NONE
+    );
+}
+
+bool HTSpread::is_animating() {
+    return perc->isBeingAnimated();
+}
+
+void HTSpread::open(WORKSPACEID ws_id) {
+    if (ws_id != spread_ws) {
+        slots.clear();
+        packed_generation = 0;
+    }
+    spread_ws = ws_id;
+    perc->resetAllCallbacks();
+    *perc = 1.f;
+}
+
+void HTSpread::close(bool warp) {
+    perc->resetAllCallbacks();
+    auto clear = [this](auto self) {
+        spread_ws = WORKSPACE_INVALID;
+        slots.clear();
+        packed_generation = 0;
+    };
+    if (warp || !active()) {
+        perc->setValueAndWarp(0.f);
+        clear(nullptr);
+        return;
+    }
+    *perc = 0.f;
+    perc->setCallbackOnEnd(clear);
+}
+
+void HTSpread::invalidate() {
+    generation++;
+}
+
+void HTSpread::update_packing(PHLMONITOR monitor) {
+    const Vector2D area = monitor->m_size;
+    if (packed_generation == generation && area == packed_size)
+        return;
+
+    packed_generation = generation;
+    packed_size = area;
+    slots.clear();
+
+    std::vector<PHLWINDOW> windows;
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || !window->m_isMapped || window->isHidden())
+            continue;
+        if (window->workspaceID() != spread_ws)
+            continue;
+        windows.push_back(window);
+    }
+    if (windows.empty())
+        return;
+
+    // Keep the reading order of the real arrangement
+    std::sort(windows.begin(), windows.end(), [](const PHLWINDOW& a, const PHLWINDOW& b) {
+        const Vector2D ca = a->m_realPosition->goal() + a->m_realSize->goal() / 2.;
+        const Vector2D cb = b->m_realPosition->goal() + b->m_realSize->goal() / 2.;
+        return ca.y != cb.y ? ca.y < cb.y : ca.x < cb.x;
+    });
+
+    const double GAP = HTConfig::value<Config::FLOAT>("gap_size");
+    const Vector2D usable = area - Vector2D {GAP * 2, GAP * 2};
+    const size_t n = windows.size();
+
+    // Pick the row count that shows the most window area, windows are never enlarged
+    size_t best_rows = 1;
+    double best_score = -1.;
+    for (size_t rows = 1; rows <= n; rows++) {
+        const size_t cols = (n + rows - 1) / rows;
+        const double cw = (usable.x - GAP * (cols - 1)) / cols;
+        const double ch = (usable.y - GAP * (rows - 1)) / rows;
+        if (cw <= 0. || ch <= 0.)
+            break;
+        double score = 0.;
+        for (const PHLWINDOW& window : windows) {
+            const Vector2D size = window->m_realSize->goal();
+            if (size.x <= 0. || size.y <= 0.)
+                continue;
+            const double s = std::min({cw / size.x, ch / size.y, 1.});
+            score += s * s * size.x * size.y;
+        }
+        if (score > best_score) {
+            best_score = score;
+            best_rows = rows;
+        }
+    }
+
+    const size_t cols = (n + best_rows - 1) / best_rows;
+    const double cw = (usable.x - GAP * (cols - 1)) / cols;
+    const double ch = (usable.y - GAP * (best_rows - 1)) / best_rows;
+    slots.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const size_t row = i / cols;
+        const size_t col = i % cols;
+        // Center a short last row
+        const size_t in_row = std::min(cols, n - row * cols);
+        const double row_offset = (cols - in_row) * (cw + GAP) / 2.;
+        slots.push_back({
+            windows[i],
+            CBox {
+                GAP + row_offset + col * (cw + GAP),
+                GAP + row * (ch + GAP),
+                cw,
+                ch,
+            },
+        });
+    }
+}
+
+CBox HTSpread::target_box(const SSlot& slot, PHLMONITOR monitor) {
+    const PHLWINDOW window = slot.window.lock();
+    if (window == nullptr)
+        return {};
+    const Vector2D size = window->m_realSize->value();
+    if (size.x <= 0. || size.y <= 0.)
+        return {};
+    const double s = std::min({slot.cell.w / size.x, slot.cell.h / size.y, 1.});
+    const Vector2D fit = size * s;
+    return {monitor->m_position + slot.cell.pos() + (slot.cell.size() - fit) / 2., fit};
+}
+
+void HTSpread::render(HTLayoutBase& layout, PHLMONITOR monitor, const Time::steady_tp& time) {
+    if (!active() || monitor == nullptr)
+        return;
+    update_packing(monitor);
+
+    const float p = perc->value();
+
+    dim_batch.background_boxes.clear();
+    pool_push(dim_batch.background_boxes, CBox {{0, 0}, monitor->m_transformedSize});
+    dim_batch.background = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
+    dim_batch.background.a = p * DIM_ALPHA;
+    add_pass_element<HTPassElement>(HTPassElement::HT_PASS_DIM, &dim_batch);
+
+    for (const SSlot& slot : slots) {
+        const PHLWINDOW window = slot.window.lock();
+        if (window == nullptr)
+            continue;
+        const CBox target = target_box(slot, monitor);
+        if (target.empty())
+            continue;
+        CBox source = layout.get_global_window_box(window, spread_ws);
+        if (source.empty())
+            source = window->getWindowMainSurfaceBox();
+        const CBox box = {
+            source.pos() + (target.pos() - source.pos()) * p,
+            source.size() + (target.size() - source.size()) * p,
+        };
+        // Not damaged, so a settled spread stops rendering like the rest of the overview
+        render_window_at_box(window, monitor, time, box, false);
+    }
+}
+
+PHLWINDOW HTSpread::window_at(PHLMONITOR monitor, Vector2D pos) {
+    if (!active() || monitor == nullptr)
+        return nullptr;
+    for (const SSlot& slot : slots) {
+        if (target_box(slot, monitor).containsPoint(pos))
+            return slot.window.lock();
+    }
+    return nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../pass/pass_element.hpp"
+
+class HTLayoutBase;
+
+// Exposé of one workspace: its windows zoom out of their cell into a non-overlapping
+// arrangement over the whole monitor. The packing is only solved again when the set of
+// windows on the workspace changes; resizes just refit a window into its packed cell
+class HTSpread {
+  public:
+    HTSpread();
+
+    WORKSPACEID workspace() const { return spread_ws; }
+    bool active() const { return spread_ws != WORKSPACE_INVALID; }
+    bool is_animating();
+
+    void open(WORKSPACEID ws_id);
+    // Animates back into the cell unless warp is set
+    void close(bool warp = false);
+
+    // Draws on top of whatever the layout rendered so far
+    void render(HTLayoutBase& layout, PHLMONITOR monitor, const Time::steady_tp& time);
+    // The spread window under pos (global), nullptr if none
+    PHLWINDOW window_at(PHLMONITOR monitor, Vector2D pos);
+
+    // Marks every spread's packing stale, called when a window opens, closes or changes
+    // workspace so rendering never has to scan the compositor's windows to find out
+    static void invalidate();
+
+  private:
+    PHLANIMVAR<float> perc;
+    WORKSPACEID spread_ws = WORKSPACE_INVALID;
+
+    struct SSlot {
+        PHLWINDOWREF window;
+        // Monitor-local logical box the window is fit into
+        CBox cell;
+    };
+    std::vector<SSlot> slots;
+    HTPassElement::SData dim_batch;
+    // Generation and monitor size the slots were solved for
+    uint64_t packed_generation = 0;
+    Vector2D packed_size;
+    static uint64_t generation;
+
+    void update_packing(PHLMONITOR monitor);
+    // Where window ends up, in global coordinates
+    CBox target_box(const SSlot& slot, PHLMONITOR monitor);
+};
@@ -1,5 +1,9 @@
 #include <linux/input-event-codes.h>
 
+#include <charconv>
+#include <optional>
+#include <sstream>
+
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/config/shared/actions/ConfigActions.hpp>
@@ -20,17 +24,27 @@
 #include <hyprlang.hpp>
 #include <hyprutils/math/Box.hpp>
 #include <hyprutils/math/Vector2D.hpp>
+#include <hyprutils/string/String.hpp>
 #include <lua.hpp>
 
+#include "cell_cache.hpp"
 #include "config.hpp"
 #include "config/ConfigManager.hpp"
+#include "events.hpp"
 #include "globals.hpp"
+#include "latency.hpp"
 #include "layout/grid.hpp"
 #include "overview.hpp"
+#include "render.hpp"
+#include "search.hpp"
+#include "slot_store.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
 #include "types.hpp"
 
 using namespace Config::Actions;
 using namespace Config::Values;
+using Hyprutils::String::trim;
 
 APICALL EXPORT std::string PLUGIN_API_VERSION() {
     return HYPRLAND_API_VERSION;
@@ -91,35 +105,38 @@ static SDispatchResult dispatch_if(std::string arg, bool is_active) {
     return dispatch(arg);
 }
 
-static void set_layer(PHTVIEW view, int new_layer) {
-    if (view == nullptr)
-        return;
+// Applies a setlayer argument ("+1", "-2", "3", "" == "+1") to layer. Returns false if the
+// argument is not a number, with error set, or if the result is out of bounds and
+// grid:loop_layers is disabled
+static bool resolve_layer(const std::string& arg, int& layer, std::string& error) {
+    const int LAYERS = HTConfig::value<Config::INTEGER>("grid:layers");
+    const int LOOP_LAYERS = HTConfig::value<Config::INTEGER>("grid:loop_layers");
 
-    // HACK: Prevent no focus when closing the view
-    // Makes layers less responsive and less buggy
-    // Ideally we would wait for it to close and then update
-    // Or update the destination as the offset is changing
-    // If you wanna fix this, then test it
-    // on a multimonitor setup with this command:
-    //   hyprctl dispatch --batch 'dispatch hyprtasking:setlayer -1;
-    //   dispatch hyprtasking:move left;
-    //   dispatch hyprtasking:toggle cursor;
-    //   dispatch hyprtasking:setlayer -1;
-    //   dispatch hyprtasking:toggle cursor;
-    //   dispatch hyprtasking:toggle cursor;
-    //   dispatch hyprtasking:move down;
-    //   dispatch hyprtasking:setlayer +1;
-    //   dispatch hyprtasking:toggle cursor'
-    if (view->closing)
-        return;
-    Log::logger->log(
-        LOG,
-        "[Hyprtasking] View \"{}\", previous layer: {}, new: {}",
-        view->get_monitor()->m_name,
-        view->layout->layer,
-        new_layer
-    );
-    view->layout->layer = new_layer;
+    const bool relative = !arg.empty() && (arg[0] == '+' || arg[0] == '-');
+    // from_chars takes a leading '-' but not a '+'
+    const char* begin = arg.data() + (!arg.empty() && arg[0] == '+' ? 1 : 0);
+    const char* end = arg.data() + arg.size();
+    int value = 1;
+    if (!arg.empty()) {
+        const auto [ptr, ec] = std::from_chars(begin, end, value);
+        if (ec != std::errc {} || ptr != end || begin == end) {
+            error = "invalid layer: " + arg;
+            return false;
+        }
+    }
+
+    if (arg.empty() || relative) {
+        layer += value;
+    } else {
+        layer = value;
+    }
+
+    if (layer < 0 || layer >= LAYERS) {
+        if (!LOOP_LAYERS)
+            return false;
+        layer = ((layer % LAYERS) + LAYERS) % LAYERS;
+    }
+    return true;
 }
 
 static SDispatchResult change_layer(std::string arg, bool move_window) {
@@ -133,22 +150,10 @@ static SDispatchResult change_layer(std::string arg, bool move_window) {
     if (cursor_view->layout->layout_name() != "grid")
         return {.success = false, .error = "layers are only supported in grid layout"};
 
-    const int LAYERS = HTConfig::value<Config::INTEGER>("grid:layers");
-    const int LOOP_LAYERS = HTConfig::value<Config::INTEGER>("grid:loop_layers");
-    const int original_layer = cursor_view->layout->layer;
-
-    int resulting_layer = original_layer;
-    if (arg[0] == '+' || arg[0] == '-') {
-        resulting_layer += std::stoi(arg);
-    } else {
-        resulting_layer = std::stoi(arg);
-    }
-
-    if (resulting_layer < 0 || resulting_layer >= LAYERS) {
-        if (!LOOP_LAYERS)
-            return {};
-        resulting_layer = ((resulting_layer % LAYERS) + LAYERS) % LAYERS;
-    }
+    int resulting_layer = cursor_view->layout->layer;
+    std::string error;
+    if (!resolve_layer(arg, resulting_layer, error))
+        return {.success = error.empty(), .error = error};
 
     const PHLMONITOR monitor = cursor_view->get_monitor();
     if (monitor == nullptr)
@@ -169,7 +174,7 @@ static SDispatchResult change_layer(std::string arg, bool move_window) {
     if (target_ws_id == WORKSPACE_INVALID)
         return {.success = false, .error = "target slot has no workspace"};
 
-    set_layer(cursor_view, resulting_layer);
+    cursor_view->set_layer(resulting_layer);
     cursor_view->move_id(target_ws_id, move_window);
     return {};
 }
@@ -202,17 +207,47 @@ DISPATCHER(toggle) {
     return {};
 }
 
-DISPATCHER(move) {
+DISPATCHER(spread) {
     if (ht_manager == nullptr)
         return {.success = false, .error = "ht_manager is null"};
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
     if (cursor_view == nullptr)
         return {.success = false, .error = "cursor_view is null"};
-    if (arg == "in") {
-        return change_layer("-1", false);
-    } if (arg == "out") {
-        return change_layer("+1", false);
+
+    HTSpread& spread = cursor_view->layout->spread;
+    if (spread.active()) {
+        spread.close();
+        cursor_view->request_frame();
+        return {};
     }
+
+    const PHLMONITOR monitor = cursor_view->get_monitor();
+    if (monitor == nullptr || monitor->m_activeWorkspace == nullptr)
+        return {.success = false, .error = "monitor has no active workspace"};
+
+    // Spread the hovered workspace, or the active one when the overview is closed
+    WORKSPACEID ws_id = monitor->m_activeWorkspace->m_id;
+    if (!cursor_view->active) {
+        cursor_view->show();
+    } else if (!cursor_view->closing) {
+        const WORKSPACEID hovered =
+            cursor_view->layout->get_ws_id_from_global(g_pInputManager->getMouseCoordsInternal());
+        if (g_pCompositor->getWorkspaceByID(hovered) != nullptr)
+            ws_id = hovered;
+    }
+    spread.open(ws_id);
+    cursor_view->request_frame();
+    return {};
+}
+
+DISPATCHER(move) {
+    if (ht_manager == nullptr)
+        return {.success = false, .error = "ht_manager is null"};
+    const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
+    if (cursor_view == nullptr)
+        return {.success = false, .error = "cursor_view is null"};
+    if ((arg == "in" || arg == "out") && cursor_view->layout->layout_name() != "grid")
+        return {.success = false, .error = "layers are only supported in grid layout"};
     cursor_view->move(arg, false);
     return {};
 }
@@ -223,12 +258,9 @@ DISPATCHER(movewindow) {
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
     if (cursor_view == nullptr)
         return {.success = false, .error = "cursor_view is null"};
+    if ((arg == "in" || arg == "out") && cursor_view->layout->layout_name() != "grid")
+        return {.success = false, .error = "layers are only supported in grid layout"};
     cursor_view->move(arg, true);
-    if (arg == "in") {
-        return change_layer("-1", true);
-    } if (arg == "out") {
-        return change_layer("+1", true);
-    }
     return {};
 }
 
@@ -240,6 +272,199 @@ DISPATCHER(setlayerwindow) {
     return change_layer(arg, true);
 }
 
+// Runs a ';' separated list of move/movewindow/setlayer/setlayerwindow commands, e.g.
+// "setlayer -1; move left; movewindow down". Every command is resolved against a single
+// layout snapshot and only the net result is applied, with one workspace change and one
+// animation instead of one per command.
+static SDispatchResult dispatch_batch(std::string arg) {
+    if (ht_manager == nullptr)
+        return {.success = false, .error = "ht_manager is null"};
+    const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
+    if (cursor_view == nullptr)
+        return {.success = false, .error = "cursor_view is null"};
+    if (cursor_view->closing)
+        return {};
+
+    const PHLMONITOR monitor = cursor_view->get_monitor();
+    if (monitor == nullptr)
+        return {.success = false, .error = "monitor is null"};
+    const PHLWORKSPACE active_workspace = monitor->m_activeWorkspace;
+    if (active_workspace == nullptr)
+        return {.success = false, .error = "active_workspace is null"};
+
+    const SP<HTLayoutBase>& layout = cursor_view->layout;
+    HTLayoutGrid* grid =
+        layout->layout_name() == "grid" ? static_cast<HTLayoutGrid*>(layout.get()) : nullptr;
+
+    // Commands are resolved through the layout's neighbour lookup, which is stable for the
+    // whole batch; only anchor the (single) animation on the current workspace
+    if (!cursor_view->navigating && !cursor_view->active)
+        layout->init_position();
+
+    const int original_layer = layout->layer;
+    WORKSPACEID view_ws_id = active_workspace->m_id;
+    WORKSPACEID window_ws_id = WORKSPACE_INVALID;
+    int sim_layer = original_layer;
+    PHLWINDOW window = nullptr;
+
+    std::stringstream stream(arg);
+    std::string command;
+    SDispatchResult result = {};
+    while (std::getline(stream, command, ';')) {
+        command = trim(command);
+        if (command.empty())
+            continue;
+        if (command.starts_with("hyprtasking:"))
+            command = command.substr(12);
+
+        const size_t space = command.find_first_of(' ');
+        const std::string name = command.substr(0, space);
+        const std::string op_arg =
+            space == std::string::npos ? "" : trim(command.substr(space + 1));
+
+        const bool move_window = name == "movewindow" || name == "setlayerwindow";
+        if (move_window && window == nullptr) {
+            window = ht_manager->get_window_from_cursor();
+            if (window == nullptr)
+                continue;
+            window_ws_id = window->workspaceID();
+        }
+
+        // movewindow is relative to the window, everything else to the view
+        const WORKSPACEID source_ws_id = name == "movewindow" ? window_ws_id : view_ws_id;
+        WORKSPACEID target_ws_id = WORKSPACE_INVALID;
+
+        if (name == "move" || name == "movewindow") {
+            const HTDirection direction = parse_direction(op_arg);
+            if ((direction == HT_DIR_IN || direction == HT_DIR_OUT) && grid == nullptr) {
+                result = {.success = false, .error = "layers are only supported in grid layout"};
+                break;
+            }
+            target_ws_id = layout->get_neighbour(source_ws_id, direction);
+            if (target_ws_id != WORKSPACE_INVALID)
+                sim_layer = layout->get_ws_layer(target_ws_id);
+        } else if (name == "setlayer" || name == "setlayerwindow") {
+            if (grid == nullptr) {
+                result = {.success = false, .error = "layers are only supported in grid layout"};
+                break;
+            }
+            const auto it = grid->cache().find(source_ws_id);
+            if (it == grid->cache().end())
+                continue;
+            int new_layer = sim_layer;
+            std::string error;
+            if (!resolve_layer(op_arg, new_layer, error)) {
+                if (error.empty())
+                    continue;
+                result = {.success = false, .error = error};
+                break;
+            }
+            target_ws_id = grid->slot_workspace(new_layer, it->second.x, it->second.y);
+            if (target_ws_id != WORKSPACE_INVALID)
+                sim_layer = new_layer;
+        } else {
+            result = {.success = false, .error = "invalid batch command: " + command};
+            break;
+        }
+
+        if (target_ws_id == WORKSPACE_INVALID)
+            continue;
+
+        view_ws_id = target_ws_id;
+        if (move_window)
+            window_ws_id = target_ws_id;
+    }
+
+    if (!result.success)
+        return result;
+
+    Log::logger->log(
+        LOG,
+        "[Hyprtasking] batch \"{}\" resolved to workspace {} on layer {}",
+        arg,
+        view_ws_id,
+        sim_layer
+    );
+
+    if (sim_layer != original_layer)
+        cursor_view->set_layer(sim_layer);
+
+    // The window was left behind by later view moves, so drop it off without following it
+    const bool window_follows = window != nullptr && window_ws_id == view_ws_id;
+    if (window != nullptr && !window_follows && window_ws_id != window->workspaceID()) {
+        PHLWORKSPACE window_workspace = g_pCompositor->getWorkspaceByID(window_ws_id);
+        if (window_workspace == nullptr)
+            window_workspace = g_pCompositor->createNewWorkspace(window_ws_id, monitor->m_id);
+        if (window_workspace != nullptr)
+            g_pCompositor->moveWindowToWorkspaceSafe(window, window_workspace);
+    }
+
+    if (view_ws_id != active_workspace->m_id
+        || (window_follows && window_ws_id != window->workspaceID()))
+        cursor_view->move_id(view_ws_id, window_follows);
+    return {};
+}
+
+static int lua_batch(lua_State* L) {
+    // Accept either a list of commands or a single ';' separated string
+    std::string arg;
+    if (lua_istable(L, 1)) {
+        const lua_Integer len = luaL_len(L, 1);
+        for (lua_Integer i = 1; i <= len; i++) {
+            lua_geti(L, 1, i);
+            arg += std::string(luaL_checkstring(L, -1)) + ";";
+            lua_pop(L, 1);
+        }
+    } else {
+        arg = luaL_optstring(L, 1, "");
+    }
+
+    const auto RESULT = dispatch_batch(arg);
+    if (!RESULT.success)
+        return luaL_error(L, "%s", RESULT.error.c_str());
+    return 0;
+}
+
+DISPATCHER(trace) {
+    const size_t space = arg.find_first_of(' ');
+    const std::string command = arg.substr(0, space);
+    const std::string path =
+        space == std::string::npos ? "/tmp/hyprtasking-trace.json" : trim(arg.substr(space + 1));
+
+    if (command == "start") {
+        HTTrace::start(1 << 16);
+    } else if (command == "stop") {
+        HTTrace::stop();
+    } else if (command == "dump") {
+        const std::string error = HTTrace::dump(path);
+        if (!error.empty())
+            return {.success = false, .error = error};
+        Log::logger->log(LOG, "[Hyprtasking] Wrote trace to {}", path);
+    } else {
+        return {.success = false, .error = "invalid arg: " + arg};
+    }
+    return {};
+}
+
+DISPATCHER(latency) {
+    if (arg == "reset") {
+        HTLatency::reset();
+        return {};
+    }
+    if (arg != "report" && arg != "")
+        return {.success = false, .error = "invalid arg: " + arg};
+
+    const std::string report = HTLatency::report();
+    Log::logger->log(LOG, "[Hyprtasking] Input to present latency:\n{}", report);
+    HyprlandAPI::addNotification(
+        PHANDLE,
+        "[Hyprtasking] " + report,
+        CHyprColor {0.2, 0.6, 1.0, 1.0},
+        10000
+    );
+    return {};
+}
+
 // Convert ActionResult to SDispatchResult
 static SDispatchResult wrap(ActionResult res) {
     if (!res)
@@ -275,8 +500,9 @@ static void hook_render_workspace(
                                   ->m_original))(thisptr, monitor, workspace, now, geometry);
         return;
     }
+    // Monitors without an overview of their own render normally and keep direct scanout
     const PHTVIEW view = ht_manager->get_view_from_monitor(monitor);
-    if ((view != nullptr && view->navigating) || ht_manager->has_active_view()) {
+    if (view != nullptr && view->renders_overview()) {
         view->layout->render();
     } else {
         ((render_workspace_t)(render_workspace_hook
@@ -290,26 +516,26 @@ static bool hook_should_render_window(void* thisptr, PHLWINDOW window, PHLMONITO
     if (ht_manager == nullptr || !ht_manager->has_active_view())
         return ori_result;
     const PHTVIEW view = ht_manager->get_view_from_monitor(monitor);
-    if (view == nullptr)
+    if (view == nullptr || !view->renders_overview())
         return ori_result;
     return view->layout->should_render_window(window);
 }
 
 static uint32_t hook_is_solitary_blocked(void* thisptr, bool full) {
-    PHTVIEW view = ht_manager->get_view_from_cursor();
-    if (view == nullptr) {
-        Log::logger->log(Log::ERR, "[Hyprtasking] View is nullptr in hook_is_solitary_blocked");
-        (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
-    }
-
-    if (view->active || view->navigating) {
+    // thisptr is the monitor being asked, decide from its own view rather than the cursor's
+    const CMonitor* monitor = static_cast<CMonitor*>(thisptr);
+    const PHTVIEW view =
+        ht_manager == nullptr ? nullptr : ht_manager->get_view_from_id(monitor->m_id);
+    if (view != nullptr && view->renders_overview())
         return CMonitor::SC_UNKNOWN;
-    }
     return (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
 }
 
 static void on_mouse_button(IPointer::SButtonEvent e, Event::SCallbackInfo& info) {
-    if (ht_manager == nullptr)
+    // A drag started in the overview must still see its release after the overview closed,
+    // or the window is left in move mode
+    const bool dragging = g_layoutManager->dragController()->target() != nullptr;
+    if (ht_manager == nullptr || (!ht_manager->overview_engaged() && !dragging))
         return;
 
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
@@ -331,13 +557,13 @@ static void on_mouse_button(IPointer::SButtonEvent e, Event::SCallbackInfo& info
 }
 
 static void on_mouse_move(Vector2D c, Event::SCallbackInfo& info) {
-    if (ht_manager == nullptr)
+    if (ht_manager == nullptr || !ht_manager->overview_engaged())
         return;
     info.cancelled = ht_manager->on_mouse_move();
 }
 
 static void on_mouse_axis(IPointer::SAxisEvent e, Event::SCallbackInfo& info) {
-    if (ht_manager == nullptr)
+    if (ht_manager == nullptr || !ht_manager->overview_engaged())
         return;
     info.cancelled = ht_manager->on_mouse_axis(e.delta);
 }
@@ -360,8 +586,33 @@ static void on_swipe_end(IPointer::SSwipeEndEvent e, Event::SCallbackInfo& info)
     info.cancelled = ht_manager->swipe_end();
 }
 
+static void on_key(IKeyboard::SKeyEvent e, Event::SCallbackInfo& info) {
+    if (ht_manager == nullptr)
+        return;
+    info.cancelled = ht_manager->on_key(e);
+}
+
+static void on_workspace_created(PHLWORKSPACE workspace) {
+    if (ht_manager == nullptr)
+        return;
+    ht_manager->on_workspace_created(workspace);
+}
+
+static void on_workspace_removed(PHLWORKSPACE workspace) {
+    if (ht_manager == nullptr)
+        return;
+    ht_manager->on_workspace_removed(workspace);
+}
+
+static void on_workspace_moved(PHLWORKSPACE workspace, PHLMONITOR monitor) {
+    if (ht_manager == nullptr)
+        return;
+    ht_manager->on_workspace_moved(workspace);
+}
+
 static void cancel_event(Event::SCallbackInfo& info) {
-    if (ht_manager == nullptr || !ht_manager->cursor_view_active())
+    if (ht_manager == nullptr || !ht_manager->overview_engaged()
+        || !ht_manager->cursor_view_active())
         return;
     info.cancelled = true;
 }
@@ -369,11 +620,17 @@ static void cancel_event(Event::SCallbackInfo& info) {
 static void register_monitors() {
     if (ht_manager == nullptr)
         return;
+    // Workspaces may have moved around while monitors were changing, and rules bound by
+    // monitor name may resolve differently
+    ht_manager->rebuild_workspace_index();
+    ht_manager->rebuild_rule_index();
     for (const PHLMONITOR& monitor : g_pCompositor->m_monitors) {
         // Skip monitors that haven't finished initializing
         if (monitor->m_transformedSize.x < 1 || monitor->m_transformedSize.y < 1)
             continue;
 
+        HTLatency::watch_monitor(monitor);
+
         const PHTVIEW view = ht_manager->get_view_from_monitor(monitor);
         if (view != nullptr) {
             if (!view->active)
@@ -381,6 +638,7 @@ static void register_monitors() {
             continue;
         }
         ht_manager->views.push_back(makeShared<HTView>(monitor->m_id));
+        HTSnapshot::invalidate();
 
         Log::logger->log(
             LOG,
@@ -397,19 +655,39 @@ static void on_monitor_removed(PHLMONITOR monitor) {
     if (ht_manager == nullptr || monitor == nullptr)
         return;
     ht_manager->remove_view_for_monitor_id(monitor->m_id);
+    HTSnapshot::invalidate();
+    HTLatency::unwatch_monitor(monitor->m_id);
+    ht_manager->rebuild_workspace_index();
+    ht_manager->rebuild_rule_index();
     ht_manager->refresh_all_grid_caches();
 }
 
+// Plugin config as of the last reload, nothing until the first one
+static std::optional<HTConfig::Snapshot> config_snapshot;
+
 static void on_config_reloaded() {
     if (ht_manager == nullptr)
         return;
 
-    // re-init scale and offset for inactive views, change layout if changed
+    ht_manager->rebuild_rule_index();
+    // Hyprland's own values (borders, rounding, shadows) change how every cell looks too
+    HTCellCache::invalidate();
+    HTConfig::Snapshot current = HTConfig::snapshot();
+    const uint32_t changes =
+        config_snapshot ? HTConfig::diff(*config_snapshot, current) : HT_CONFIG_ALL;
+    config_snapshot = std::move(current);
+
+    if (changes == HT_CONFIG_NONE)
+        return;
+    HTSnapshot::invalidate();
+
+    // Render and input values apply live; anything that moves cells closes the overview
+    const bool structural = changes & (HT_CONFIG_LAYOUT | HT_CONFIG_SLOTS | HT_CONFIG_GEOMETRY);
     for (PHTVIEW& view : ht_manager->views) {
         if (view == nullptr)
             continue;
-        const Config::STRING new_layout = HTConfig::value<Config::STRING>("layout");
-        if (HTConfig::value<Config::INTEGER>("close_overview_on_reload")
+        const Config::STRING& new_layout = config_snapshot->layout;
+        if ((structural && HTConfig::value<Config::INTEGER>("close_overview_on_reload"))
             || view->layout->layout_name() != new_layout) {
             Log::logger->log(LOG, "[Hyprtasking] Closing overview on config reload");
             view->hide(false);
@@ -417,7 +695,32 @@ static void on_config_reloaded() {
         }
     }
 
-    ht_manager->refresh_all_grid_caches();
+    if (changes & HT_CONFIG_SLOTS) {
+        ht_manager->refresh_all_grid_caches();
+    } else if (changes & HT_CONFIG_NAV) {
+        for (PHTVIEW& view : ht_manager->views) {
+            if (view == nullptr || view->layout->layout_name() != "grid")
+                continue;
+            static_cast<HTLayoutGrid*>(view->layout.get())->build_nav_graph();
+        }
+    }
+
+    if (changes & (HT_CONFIG_SLOTS | HT_CONFIG_GEOMETRY)) {
+        // re-init the closed layout of inactive views against the new slots and gaps
+        for (PHTVIEW& view : ht_manager->views) {
+            if (view == nullptr || view->active)
+                continue;
+            view->layout->init_position();
+        }
+    }
+
+    if (changes & HT_CONFIG_RENDER) {
+        for (PHTVIEW& view : ht_manager->views) {
+            if (view == nullptr || !view->active || view->get_monitor() == nullptr)
+                continue;
+            damage_monitor(view->get_monitor());
+        }
+    }
 }
 
 static void init_functions() {
@@ -489,6 +792,21 @@ static void register_callbacks() {
     static auto P10 = Event::bus()->m_events.config.reloaded.listen(on_config_reloaded);
     static auto P11 = Event::bus()->m_events.monitor.added.listen(register_monitors);
     static auto P12 = Event::bus()->m_events.monitor.removed.listen(on_monitor_removed);
+    // Mode, scale and position changes move every cell's global box
+    static auto P13 = Event::bus()->m_events.monitor.layoutChanged.listen([] { HTSnapshot::invalidate(); });
+
+    static auto P14 = Event::bus()->m_events.workspace.created.listen(on_workspace_created);
+    static auto P15 = Event::bus()->m_events.workspace.removed.listen(on_workspace_removed);
+    static auto P16 = Event::bus()->m_events.workspace.moveToMonitor.listen(on_workspace_moved);
+
+    static auto P17 = Event::bus()->m_events.input.keyboard.key.listen(on_key);
+    static auto P18 = Event::bus()->m_events.window.open.listen(HTSearch::add_window);
+    static auto P19 = Event::bus()->m_events.window.close.listen(HTSearch::remove_window);
+    static auto P20 = Event::bus()->m_events.window.title.listen(HTSearch::update_window);
+
+    static auto P21 = Event::bus()->m_events.window.open.listen([] (PHLWINDOW) { HTSpread::invalidate(); HTCellCache::invalidate(); });
+    static auto P22 = Event::bus()->m_events.window.close.listen([] (PHLWINDOW) { HTSpread::invalidate(); HTCellCache::invalidate(); });
+    static auto P23 = Event::bus()->m_events.window.moveToWorkspace.listen([] (PHLWINDOW, PHLWORKSPACE) { HTSpread::invalidate(); HTCellCache::invalidate(); });
 }
 
 
@@ -511,16 +829,186 @@ static int lua_is_active(lua_State* L) {
     return cursor_view->active;
 }
 
+// Plugin heap allocations while rendering, see HTFrameAllocStats
+static int lua_alloc_stats(lua_State* L) {
+    lua_createtable(L, 0, 7);
+    lua_pushinteger(L, ht_alloc_stats.frames);
+    lua_setfield(L, -2, "frames");
+    lua_pushinteger(L, ht_alloc_stats.pass_elements);
+    lua_setfield(L, -2, "pass_elements");
+    lua_pushinteger(L, ht_alloc_stats.layout_nodes);
+    lua_setfield(L, -2, "layout_nodes");
+    lua_pushinteger(L, ht_alloc_stats.last_pass_elements);
+    lua_setfield(L, -2, "last_frame_pass_elements");
+    lua_pushinteger(L, ht_alloc_stats.last_layout_nodes);
+    lua_setfield(L, -2, "last_frame_layout_nodes");
+    lua_pushinteger(L, ht_alloc_stats.storage_growths);
+    lua_setfield(L, -2, "storage_growths");
+    lua_pushinteger(L, ht_alloc_stats.last_storage_growths);
+    lua_setfield(L, -2, "last_frame_storage_growths");
+    return 1;
+}
+
+// Views, slot map and cells in one table, see HTSnapshot
+static int lua_snapshot(lua_State* L) {
+    const HTSnapshot::SData& snapshot = HTSnapshot::get();
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, snapshot.generation);
+    lua_setfield(L, -2, "generation");
+
+    lua_createtable(L, snapshot.views.size(), 0);
+    for (size_t v = 0; v < snapshot.views.size(); v++) {
+        const HTSnapshot::SView& view = snapshot.views[v];
+        lua_createtable(L, 0, 9);
+        lua_pushstring(L, view.monitor.c_str());
+        lua_setfield(L, -2, "monitor");
+        lua_pushinteger(L, view.monitor_id);
+        lua_setfield(L, -2, "monitor_id");
+        lua_pushstring(L, view.layout.c_str());
+        lua_setfield(L, -2, "layout");
+        lua_pushboolean(L, view.active);
+        lua_setfield(L, -2, "active");
+        lua_pushboolean(L, view.closing);
+        lua_setfield(L, -2, "closing");
+        lua_pushboolean(L, view.navigating);
+        lua_setfield(L, -2, "navigating");
+        lua_pushinteger(L, view.layer);
+        lua_setfield(L, -2, "layer");
+
+        lua_createtable(L, view.slots.size(), 0);
+        for (size_t i = 0; i < view.slots.size(); i++) {
+            const HTSnapshot::SSlot& slot = view.slots[i];
+            lua_createtable(L, 0, 4);
+            lua_pushinteger(L, slot.id);
+            lua_setfield(L, -2, "id");
+            lua_pushinteger(L, slot.layer);
+            lua_setfield(L, -2, "layer");
+            lua_pushinteger(L, slot.x);
+            lua_setfield(L, -2, "x");
+            lua_pushinteger(L, slot.y);
+            lua_setfield(L, -2, "y");
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_setfield(L, -2, "slots");
+
+        lua_createtable(L, view.cells.size(), 0);
+        for (size_t i = 0; i < view.cells.size(); i++) {
+            const HTSnapshot::SCell& cell = view.cells[i];
+            lua_createtable(L, 0, 7);
+            lua_pushinteger(L, cell.id);
+            lua_setfield(L, -2, "id");
+            lua_pushinteger(L, cell.x);
+            lua_setfield(L, -2, "x");
+            lua_pushinteger(L, cell.y);
+            lua_setfield(L, -2, "y");
+            lua_pushnumber(L, cell.box.x);
+            lua_setfield(L, -2, "box_x");
+            lua_pushnumber(L, cell.box.y);
+            lua_setfield(L, -2, "box_y");
+            lua_pushnumber(L, cell.box.w);
+            lua_setfield(L, -2, "box_w");
+            lua_pushnumber(L, cell.box.h);
+            lua_setfield(L, -2, "box_h");
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_setfield(L, -2, "cells");
+
+        lua_rawseti(L, -2, v + 1);
+    }
+    lua_setfield(L, -2, "views");
+    return 1;
+}
+
+#ifdef HT_RENDER_RECORDER
+// What the last overview frame would have drawn, see HTRenderRecorder
+static int lua_render_record(lua_State* L) {
+    const HTRenderRecord& record = ht_render_recorder.last;
+    lua_createtable(L, 0, 7);
+    lua_pushinteger(L, ht_render_recorder.frames);
+    lua_setfield(L, -2, "frames");
+    lua_pushinteger(L, record.pass_elements);
+    lua_setfield(L, -2, "pass_elements");
+    lua_pushinteger(L, record.damage_calls);
+    lua_setfield(L, -2, "damage_calls");
+    lua_pushinteger(L, record.blur_skipped);
+    lua_setfield(L, -2, "blur_skipped");
+    lua_pushinteger(L, record.cached_cells);
+    lua_setfield(L, -2, "cached_cells");
+
+    lua_createtable(L, record.workspaces.size(), 0);
+    for (size_t i = 0; i < record.workspaces.size(); i++) {
+        const auto& draw = record.workspaces[i];
+        lua_createtable(L, 0, 6);
+        lua_pushinteger(L, draw.monitor);
+        lua_setfield(L, -2, "monitor");
+        lua_pushinteger(L, draw.workspace);
+        lua_setfield(L, -2, "workspace");
+        lua_pushnumber(L, draw.box.x);
+        lua_setfield(L, -2, "x");
+        lua_pushnumber(L, draw.box.y);
+        lua_setfield(L, -2, "y");
+        lua_pushnumber(L, draw.box.w);
+        lua_setfield(L, -2, "w");
+        lua_pushnumber(L, draw.box.h);
+        lua_setfield(L, -2, "h");
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_setfield(L, -2, "workspaces");
+
+    lua_createtable(L, record.windows.size(), 0);
+    for (size_t i = 0; i < record.windows.size(); i++) {
+        lua_pushstring(L, record.windows[i].window.c_str());
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_setfield(L, -2, "windows");
+    return 1;
+}
+#endif
+
 static void add_dispatchers() {
     add_dispatcher(if_not_active);
     add_dispatcher(if_active);
     add_dispatcher(toggle);
+    add_dispatcher(spread);
     add_dispatcher(move);
     add_dispatcher(movewindow);
     add_dispatcher(killhovered);
     add_dispatcher(setlayer);
     add_dispatcher(setlayerwindow);
+    add_dispatcher(batch);
+    add_dispatcher(trace);
+    add_dispatcher(latency);
     HyprlandAPI::addLuaFunction(PHANDLE, "hyprtasking", "is_active", lua_is_active); \
+    HyprlandAPI::addLuaFunction(PHANDLE, "hyprtasking", "alloc_stats", lua_alloc_stats);
+    HyprlandAPI::addLuaFunction(PHANDLE, "hyprtasking", "snapshot", lua_snapshot);
+
+    // `hyprctl [-j] hyprtasking`, the same snapshot as the lua function
+    static auto SNAPSHOT_CMD = HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE,
+        SHyprCtlCommand {
+            .name = "hyprtasking",
+            .exact = true,
+            .fn = [](eHyprCtlOutputFormat format, std::string request) -> std::string {
+                if (format == eHyprCtlOutputFormat::FORMAT_JSON)
+                    return HTSnapshot::json();
+                return HTSnapshot::text();
+            },
+        }
+    );
+#ifdef HT_RENDER_RECORDER
+    HyprlandAPI::addLuaFunction(PHANDLE, "hyprtasking", "render_record", lua_render_record);
+    // `hyprctl hyprtasking-record`, the same record as JSON, read by tests/render_recorder.py
+    static auto RECORD_CMD = HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE,
+        SHyprCtlCommand {
+            .name = "hyprtasking-record",
+            .exact = true,
+            .fn = [](eHyprCtlOutputFormat format, std::string request) -> std::string {
+                return ht_render_recorder.json();
+            },
+        }
+    );
+#endif
 }
 
 #define addConfigValue(T, config, descr, value) do { \
@@ -542,6 +1030,9 @@ static void init_config() {
     addConfigValue(CIntValue, "exit_on_hovered", "exit on hovered", 0);
     addConfigValue(CIntValue, "warp_on_move_window", "warp on move window", 1);
     addConfigValue(CIntValue, "close_overview_on_reload", "close overview on reload", 1);
+    addConfigValue(CIntValue, "cell_blur", "cell blur", HT_CELL_BLUR_SHARED);
+    addConfigValue(CFloatValue, "cell_blur_live_scale", "cell blur live scale", 0.5f);
+    addConfigValue(CIntValue, "cell_cache", "cell cache", 1);
 
     addConfigValue(CIntValue, "drag_button", "drag button", BTN_LEFT);
     addConfigValue(CIntValue, "select_button", "select button", BTN_RIGHT);
@@ -554,6 +1045,10 @@ static void init_config() {
     addConfigValue(CFloatValue, "gestures:open_distance", "open distance", 300.0);
     addConfigValue(CIntValue, "gestures:open_positive", "open positive", 1);
 
+    // search
+    addConfigValue(CIntValue, "search:enabled", "enabled", 0);
+    addConfigValue(CIntValue, "search:highlight_color", "highlight color", 0x4033CCFF);
+
     // grid specific
     addConfigValue(CIntValue, "grid:rows", "rows", 3);
     addConfigValue(CIntValue, "grid:cols", "cols", 3);
@@ -589,6 +1084,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     add_dispatchers();
     register_callbacks();
     init_functions();
+    HTSlotStore::load();
+    HTSearch::rebuild();
     register_monitors();
 
     Log::logger->log(LOG, "[Hyprtasking] Plugin initialized");
@@ -601,4 +1098,8 @@ APICALL EXPORT void PLUGIN_EXIT() {
     // prevent crashes
     ht_manager->hide_all_views();
     ht_manager->reset();
+    HTSlotStore::shutdown();
+    HTEvents::shutdown();
+    HTLatency::shutdown();
+    HTCellCache::shutdown();
 }
@@ -13,6 +13,8 @@
 #include "config/shared/workspace/WorkspaceRuleManager.hpp"
 #include "layout/grid.hpp"
 #include "overview.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
 
 HTManager::HTManager() {
     swipe_state = HT_SWIPE_NONE;
@@ -116,29 +118,32 @@ void HTManager::reset() {
     swipe_state = HT_SWIPE_NONE;
     swipe_amt = 0.0;
     views.clear();
+    engaged_views = 0;
+    workspace_index.clear();
+    all_workspace_ids.clear();
+    rule_bindings = {};
 }
 
 void HTManager::refresh_all_grid_caches() {
+    HT_TRACE_SCOPE("refresh_all_grid_caches");
     // Enforce monitor-binding rules globally first. Per-grid refresh below
     // sees one workspace at a time on one monitor; if a rule-bound ws still
     // lives on the wrong monitor, the first grid to refresh would claim it
     // via Pass 2 and the rule-bound grid would then skip it via off_limits,
     // so the migration would never happen.
-    const auto& all_rules = Config::workspaceRuleMgr()->getAllWorkspaceRules();
-    for (const auto& rule : all_rules) {
-        if (rule.m_workspaceId <= 0)
-            continue;
-        const auto bound = Config::workspaceRuleMgr()->getBoundMonitorForWS(
-            rule.m_workspaceName.starts_with("name:") ? rule.m_workspaceName.substr(5)
-                                                    : rule.m_workspaceName
-        );
-        if (bound == nullptr)
+    for (const auto& [ws_id, mid] : rule_bindings.bound_monitor) {
+        if (mid == MONITOR_INVALID)
             continue;
-        const PHLWORKSPACE ws = g_pCompositor->getWorkspaceByID(rule.m_workspaceId);
+        const PHLWORKSPACE ws = g_pCompositor->getWorkspaceByID(ws_id);
         if (ws == nullptr)
             continue;
-        if (ws->m_monitor.lock() != bound)
+        if (ws->monitorID() != mid) {
+            const PHLMONITOR bound = g_pCompositor->getMonitorFromID(mid);
+            if (bound == nullptr)
+                continue;
             g_pCompositor->moveWorkspaceToMonitor(ws, bound);
+            on_workspace_moved(ws);
+        }
     }
 
     std::vector<HTLayoutGrid*> grids;
@@ -176,10 +181,131 @@ void HTManager::refresh_all_grid_caches() {
     }
 }
 
+void HTManager::rebuild_rule_index() {
+    rule_bindings.bound_monitor.clear();
+    rule_bindings.by_monitor.clear();
+    for (const auto& rule : Config::workspaceRuleMgr()->getAllWorkspaceRules()) {
+        if (rule.m_workspaceId <= 0)
+            continue;
+        const auto bound = Config::workspaceRuleMgr()->getBoundMonitorForWS(
+            rule.m_workspaceName.starts_with("name:") ? rule.m_workspaceName.substr(5)
+                                                    : rule.m_workspaceName
+        );
+        const MONITORID mid = bound == nullptr ? MONITOR_INVALID : bound->m_id;
+        rule_bindings.bound_monitor[rule.m_workspaceId] = mid;
+        if (mid != MONITOR_INVALID)
+            rule_bindings.by_monitor[mid].push_back(rule.m_workspaceId);
+    }
+    for (auto& [mid, ids] : rule_bindings.by_monitor) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+}
+
+const std::vector<WORKSPACEID>& HTManager::get_bound_workspaces(MONITORID mid) const {
+    static const std::vector<WORKSPACEID> none;
+    const auto it = rule_bindings.by_monitor.find(mid);
+    if (it == rule_bindings.by_monitor.end())
+        return none;
+    return it->second;
+}
+
+void HTManager::rebuild_workspace_index() {
+    workspace_index.clear();
+    all_workspace_ids.clear();
+    for (const PHLWORKSPACE& workspace : g_pCompositor->getWorkspacesCopy()) {
+        if (workspace == nullptr)
+            continue;
+        all_workspace_ids.push_back(workspace->m_id);
+        if (workspace->m_isSpecialWorkspace)
+            continue;
+        workspace_index[workspace->monitorID()].ids.push_back(workspace->m_id);
+    }
+    std::sort(all_workspace_ids.begin(), all_workspace_ids.end());
+    for (auto& [mid, entry] : workspace_index)
+        std::sort(entry.ids.begin(), entry.ids.end());
+    update_next_free_ids();
+}
+
+void HTManager::index_insert(MONITORID mid, WORKSPACEID ws_id) {
+    std::vector<WORKSPACEID>& ids = workspace_index[mid].ids;
+    const auto it = std::lower_bound(ids.begin(), ids.end(), ws_id);
+    if (it == ids.end() || *it != ws_id)
+        ids.insert(it, ws_id);
+}
+
+void HTManager::index_erase(WORKSPACEID ws_id) {
+    for (auto& [mid, entry] : workspace_index) {
+        const auto it = std::lower_bound(entry.ids.begin(), entry.ids.end(), ws_id);
+        if (it != entry.ids.end() && *it == ws_id)
+            entry.ids.erase(it);
+    }
+}
+
+void HTManager::update_next_free_ids() {
+    // Every index change ends here, and linear snapshot cells are read from the index
+    HTSnapshot::invalidate();
+    for (auto& [mid, entry] : workspace_index) {
+        WORKSPACEID candidate = entry.ids.empty() ? 1 : entry.ids.back() + 1;
+        auto it = std::lower_bound(all_workspace_ids.begin(), all_workspace_ids.end(), candidate);
+        while (it != all_workspace_ids.end() && *it == candidate) {
+            candidate++;
+            it++;
+        }
+        entry.next_free_id = candidate;
+    }
+}
+
+void HTManager::on_workspace_created(PHLWORKSPACE workspace) {
+    if (workspace == nullptr)
+        return;
+    const auto it =
+        std::lower_bound(all_workspace_ids.begin(), all_workspace_ids.end(), workspace->m_id);
+    if (it == all_workspace_ids.end() || *it != workspace->m_id)
+        all_workspace_ids.insert(it, workspace->m_id);
+    if (!workspace->m_isSpecialWorkspace)
+        index_insert(workspace->monitorID(), workspace->m_id);
+    update_next_free_ids();
+}
+
+void HTManager::on_workspace_removed(PHLWORKSPACE workspace) {
+    if (workspace == nullptr)
+        return;
+    const auto it =
+        std::lower_bound(all_workspace_ids.begin(), all_workspace_ids.end(), workspace->m_id);
+    if (it != all_workspace_ids.end() && *it == workspace->m_id)
+        all_workspace_ids.erase(it);
+    index_erase(workspace->m_id);
+    update_next_free_ids();
+}
+
+void HTManager::on_workspace_moved(PHLWORKSPACE workspace) {
+    if (workspace == nullptr)
+        return;
+    index_erase(workspace->m_id);
+    if (!workspace->m_isSpecialWorkspace)
+        index_insert(workspace->monitorID(), workspace->m_id);
+    update_next_free_ids();
+}
+
+const HTManager::HTMonitorWorkspaces& HTManager::get_monitor_workspaces(MONITORID mid) {
+    return workspace_index[mid];
+}
+
 void HTManager::remove_view_for_monitor_id(MONITORID mid) {
     std::erase_if(views, [mid](const PHTVIEW& v) {
         return v == nullptr || v->monitor_id == mid;
     });
+    update_overview_state();
+}
+
+void HTManager::update_overview_state() {
+    HTSnapshot::invalidate();
+    engaged_views = 0;
+    for (const PHTVIEW& view : views) {
+        if (view != nullptr && (view->active || view->navigating))
+            engaged_views++;
+    }
 }
 
 bool HTManager::has_active_view() {
@@ -2,6 +2,10 @@
 
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <hyprland/src/devices/IKeyboard.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "overview.hpp"
 
@@ -26,11 +30,42 @@ class HTManager {
     void refresh_all_grid_caches();
     void remove_view_for_monitor_id(MONITORID mid);
 
+    // Non-special workspaces per monitor, kept up to date from workspace events so
+    // layouts don't have to copy and sort the compositor's list every frame
+    struct HTMonitorWorkspaces {
+        // Sorted ascending
+        std::vector<WORKSPACEID> ids;
+        // Smallest id above the largest one in ids that has no workspace anywhere
+        WORKSPACEID next_free_id = 1;
+    };
+
+    void rebuild_workspace_index();
+    void on_workspace_created(PHLWORKSPACE workspace);
+    void on_workspace_removed(PHLWORKSPACE workspace);
+    void on_workspace_moved(PHLWORKSPACE workspace);
+    const HTMonitorWorkspaces& get_monitor_workspaces(MONITORID mid);
+
+    // Workspace rules with a positive id resolved to their bound monitor, rebuilt on config
+    // reload and monitor changes so grid refreshes don't resolve rule names every time
+    struct HTRuleBindings {
+        // Every rule-bound id, MONITOR_INVALID if its monitor is not connected
+        std::unordered_map<WORKSPACEID, MONITORID> bound_monitor;
+        // Sorted ascending
+        std::unordered_map<MONITORID, std::vector<WORKSPACEID>> by_monitor;
+    };
+
+    void rebuild_rule_index();
+    const HTRuleBindings& get_rule_bindings() const { return rule_bindings; }
+    // Ids bound to mid, sorted; empty if none
+    const std::vector<WORKSPACEID>& get_bound_workspaces(MONITORID mid) const;
+
     bool start_window_drag();
     bool end_window_drag();
     bool exit_to_workspace();
     bool on_mouse_move();
     bool on_mouse_axis(double delta);
+    // Type-to-search while the cursor's overview is open
+    bool on_key(IKeyboard::SKeyEvent e);
 
     enum swipe_state_t {
         HT_SWIPE_OPEN,
@@ -46,4 +81,25 @@ class HTManager {
 
     bool has_active_view();
     bool cursor_view_active();
+
+    // False when no view is active or navigating and no swipe is in progress, so input
+    // listeners can return before looking anything up
+    bool overview_engaged() const { return engaged_views > 0 || swipe_state != HT_SWIPE_NONE; }
+    // Recount engaged views, called whenever a view's active or navigating changes
+    void update_overview_state();
+
+  private:
+    std::unordered_map<MONITORID, HTMonitorWorkspaces> workspace_index;
+    // Every workspace id that currently exists, on any monitor, sorted
+    std::vector<WORKSPACEID> all_workspace_ids;
+    HTRuleBindings rule_bindings;
+    int engaged_views = 0;
+    // Keys whose press went to the search, so their release is swallowed too
+    std::unordered_set<uint32_t> search_keys;
+
+    bool jump_to_search_match();
+
+    void index_insert(MONITORID mid, WORKSPACEID ws_id);
+    void index_erase(WORKSPACEID ws_id);
+    void update_next_free_ids();
 };
@@ -11,10 +11,16 @@
 #include <hyprutils/math/Box.hpp>
 
 #include "config.hpp"
+#include "events.hpp"
 #include "globals.hpp"
+#include "latency.hpp"
 #include "layout/grid.hpp"
 #include "layout/linear.hpp"
+#include "render.hpp"
+#include "search.hpp"
+#include "snapshot.hpp"
 #include "src/desktop/state/FocusState.hpp"
+#include "trace.hpp"
 
 HTView::HTView(MONITORID in_monitor_id) {
     monitor_id = in_monitor_id;
@@ -27,6 +33,7 @@ HTView::HTView(MONITORID in_monitor_id) {
 }
 
 void HTView::change_layout(const std::string& layout_name) {
+    HTSnapshot::invalidate();
     if (layout != nullptr && layout->layout_name() == layout_name) {
         layout->init_position();
         return;
@@ -44,6 +51,22 @@ void HTView::change_layout(const std::string& layout_name) {
     }
 }
 
+bool HTView::renders_overview() {
+    if (active)
+        return true;
+    if (!navigating || layout == nullptr)
+        return false;
+    return layout->is_animating() || ht_manager->swipe_state == HTManager::HT_SWIPE_MOVE;
+}
+
+void HTView::request_frame() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+    damage_monitor(monitor);
+    g_pCompositor->scheduleFrameForMonitor(monitor);
+}
+
 void HTView::do_exit_behavior(bool exit_on_mouse) {
     const PHLMONITOR monitor = get_monitor();
     if (monitor == nullptr) //???
@@ -73,6 +96,7 @@ void HTView::do_exit_behavior(bool exit_on_mouse) {
 }
 
 void HTView::show(bool recalculate) {
+    HT_TRACE_SCOPE("HTView::show");
     const PHLMONITOR monitor = get_monitor();
     if (monitor == nullptr)
         return;
@@ -83,19 +107,23 @@ void HTView::show(bool recalculate) {
     active = true;
     closing = false;
     navigating = false;
+    ht_manager->update_overview_state();
+    HTSearch::clear_query();
 
     if (recalculate) {
         layout->init_position();
     }
     layout->on_show();
+    HTLatency::mark(HT_INTERACTION_OPEN, monitor);
+    HTEvents::show(monitor);
 
     Cursor::overrideController->setOverride("left_ptr", Cursor::CURSOR_OVERRIDE_UNKNOWN);
 
-    g_pHyprRenderer->damageMonitor(monitor);
-    g_pCompositor->scheduleFrameForMonitor(monitor);
+    request_frame();
 }
 
 void HTView::hide(bool exit_on_mouse) {
+    HT_TRACE_SCOPE("HTView::hide");
     const PHLMONITOR monitor = get_monitor();
     if (monitor == nullptr)
         return;
@@ -104,20 +132,25 @@ void HTView::hide(bool exit_on_mouse) {
         return;
 
     do_exit_behavior(exit_on_mouse);
+    layout->spread.close(true);
 
     active = true;
     closing = true;
     navigating = false;
+    ht_manager->update_overview_state();
+    HTSearch::clear_query();
 
     layout->on_hide([this](auto self) {
         active = false;
         closing = false;
+        ht_manager->update_overview_state();
     });
+    HTLatency::mark(HT_INTERACTION_CLOSE, monitor);
+    HTEvents::hide(monitor);
 
     Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
 
-    g_pHyprRenderer->damageMonitor(monitor);
-    g_pCompositor->scheduleFrameForMonitor(monitor);
+    request_frame();
 }
 
 void HTView::warp_window(Config::INTEGER warp, PHLWINDOW window) {
@@ -131,8 +164,43 @@ void HTView::warp_window(Config::INTEGER warp, PHLWINDOW window) {
     }
 }
 
+void HTView::set_layer(int new_layer) {
+    // HACK: Prevent no focus when closing the view
+    // Makes layers less responsive and less buggy
+    // Ideally we would wait for it to close and then update
+    // Or update the destination as the offset is changing
+    // If you wanna fix this, then test it
+    // on a multimonitor setup with this command:
+    //   hyprctl dispatch --batch 'dispatch hyprtasking:setlayer -1;
+    //   dispatch hyprtasking:move left;
+    //   dispatch hyprtasking:toggle cursor;
+    //   dispatch hyprtasking:setlayer -1;
+    //   dispatch hyprtasking:toggle cursor;
+    //   dispatch hyprtasking:toggle cursor;
+    //   dispatch hyprtasking:move down;
+    //   dispatch hyprtasking:setlayer +1;
+    //   dispatch hyprtasking:toggle cursor'
+    if (closing)
+        return;
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+    Log::logger->log(
+        LOG,
+        "[Hyprtasking] View \"{}\", previous layer: {}, new: {}",
+        monitor->m_name,
+        layout->layer,
+        new_layer
+    );
+    layout->layer = new_layer;
+    HTSnapshot::invalidate();
+    HTEvents::layer(monitor, new_layer);
+}
+
 void HTView::move_id(WORKSPACEID ws_id, bool move_window) {
+    HT_TRACE_SCOPE("HTView::move_id");
     navigating = false;
+    ht_manager->update_overview_state();
     if (closing)
         return;
     const PHLMONITOR monitor = get_monitor();
@@ -170,9 +238,14 @@ void HTView::move_id(WORKSPACEID ws_id, bool move_window) {
     warp_window(warp, hovered_window);
 
     navigating = true;
+    ht_manager->update_overview_state();
+    HTLatency::mark(HT_INTERACTION_NAVIGATE, monitor);
+    HTEvents::move(monitor, other_workspace->m_id);
     layout->on_move(active_workspace->m_id, other_workspace->m_id, [this](auto self) {
         navigating = false;
+        ht_manager->update_overview_state();
     });
+    request_frame();
 }
 
 void HTView::move(std::string arg, bool move_window) {
@@ -186,16 +259,26 @@ void HTView::move(std::string arg, bool move_window) {
     if (hovered_window == nullptr && move_window)
         return;
 
+    const HTDirection direction = parse_direction(arg);
+    if (direction == HT_DIR_COUNT)
+        return;
+
     // if moving a window, the up/down/left/right should be relative to the window (and cursor) and not necessarily the active workspace
     const WORKSPACEID source_ws_id =
         move_window ? hovered_window->workspaceID() : active_workspace->m_id;
-    if (!navigating && !active) {
+    // Anchor the animation on the current workspace. While navigating (e.g. key repeat)
+    // it already is, and the neighbour lookup does not need a fresh layout
+    if (!navigating && !active)
         layout->init_position();
-    } else {
-        layout->build_overview_layout(HT_VIEW_CLOSED);
+    const WORKSPACEID id = layout->get_neighbour(source_ws_id, direction);
+    if (id == WORKSPACE_INVALID)
+        return;
+
+    if (direction == HT_DIR_IN || direction == HT_DIR_OUT) {
+        if (closing)
+            return;
+        set_layer(layout->get_ws_layer(id));
     }
-    const auto ws_layout = layout->overview_layout[source_ws_id];
-    const WORKSPACEID id = layout->get_ws_id_in_direction(ws_layout.x, ws_layout.y, arg);
 
     move_id(id, move_window);
 }
@@ -30,12 +30,21 @@ class HTView {
     void warp_window(Config::INTEGER warp, PHLWINDOW window);
 
     PHLMONITOR get_monitor();
+    // Whether overview pixels are on screen, so the monitor draws this view's layout instead
+    // of its workspace. A closed view navigating with its animation done looks exactly like
+    // the workspace, even before the on_move callback clears navigating
+    bool renders_overview();
+    // Damage the monitor and schedule a frame, to wake an overview that stopped rendering
+    // because nothing was changing
+    void request_frame();
 
     void show(bool recalculate = true);
     void hide(bool exit_on_mouse);
 
+    // Switch the layer shown, the only place layout->layer changes outside of the layout
+    void set_layer(int new_layer);
     void move_id(WORKSPACEID ws_id, bool move_window);
-    // arg is up, down, left, right;
+    // arg is up, down, left, right, in, out (in/out only for layouts with layers)
     void move(std::string arg, bool move_window);
 };
 
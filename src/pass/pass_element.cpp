@@ -1,20 +1,199 @@
 #include "pass_element.hpp"
 
-HTPassElement::HTPassElement() {
+#include <hyprland/src/desktop/rule/windowRule/WindowRuleApplicator.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+
+HTPassElement::HTPassElement(eLayer layer, const SData* data) : layer(layer), data(*data) {
     ;
 }
 
 std::vector<UP<IPassElement>> HTPassElement::draw() {
+    switch (layer) {
+        case HT_PASS_UNDERLAY:
+        case HT_PASS_DIM:
+            draw_rects();
+            break;
+        case HT_PASS_SHARED_LAYERS:
+            draw_shared_layers();
+            break;
+        case HT_PASS_CELL_BLUR_BEGIN:
+            draw_cell_blur(true);
+            break;
+        case HT_PASS_CELL_BLUR_END:
+            draw_cell_blur(false);
+            break;
+        case HT_PASS_CELL_CAPTURE_BEGIN:
+            draw_cell_capture(true);
+            break;
+        case HT_PASS_CELL_CAPTURE_END:
+            draw_cell_capture(false);
+            break;
+        case HT_PASS_CELL_COMPOSITE:
+            draw_cell_composite();
+            break;
+        case HT_PASS_OVERLAY:
+            draw_overlay();
+            break;
+    }
     return {};
 }
 
+void HTPassElement::draw_rects() {
+    for (const CBox& box : data.background_boxes)
+        g_pHyprOpenGL->renderRect(box, data.background, {});
+}
+
+void HTPassElement::draw_cell_blur(bool begin) {
+    // xray makes a window sample the monitor's blur framebuffer instead of blurring what is
+    // behind it. Set at the lowest priority so the user's own xray rules still win
+    for (const PHLWINDOWREF& window_ref : data.blur_windows) {
+        const PHLWINDOW window = window_ref.lock();
+        if (window == nullptr)
+            continue;
+        if (begin)
+            window->m_ruleApplicator->xray().set(true, Desktop::Types::PRIORITY_LAYOUT);
+        else
+            window->m_ruleApplicator->xray().unset(Desktop::Types::PRIORITY_LAYOUT);
+    }
+}
+
+void HTPassElement::draw_shared_layers() {
+    CFramebuffer* cache = data.layer_cache;
+    CFramebuffer* target = g_pHyprOpenGL->m_renderData.currentFB;
+    const PHLMONITOR monitor = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    if (cache == nullptr || target == nullptr || monitor == nullptr || data.layer_cells.empty())
+        return;
+
+    // The cache is monitor sized so it shares the monitor's viewport and projection. Boxes,
+    // layer_cache_size and the UVs are all in pixel space, the same as the unrotated monitor
+    const Vector2D fb_size = monitor->m_pixelSize;
+    if (!cache->isAllocated() || cache->m_size != fb_size)
+        cache->alloc(fb_size.x, fb_size.y, monitor->m_output->state->state().drmFormat);
+
+    // Redraw the cache whole, whatever part of the monitor this frame damages
+    const CRegion damage = g_pHyprOpenGL->m_renderData.damage;
+    g_pHyprOpenGL->m_renderData.damage = CBox {{}, fb_size};
+    cache->bind();
+    g_pHyprOpenGL->clear(CHyprColor(0, 0, 0, 0));
+    for (const SLayerTexture& layer : data.layer_textures)
+        g_pHyprOpenGL->renderTexture(layer.texture, layer.box, {});
+    target->bind();
+    g_pHyprOpenGL->m_renderData.damage = damage;
+
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVTopLeft = {0, 0};
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVBottomRight = data.layer_cache_size / fb_size;
+    for (const CBox& cell : data.layer_cells)
+        g_pHyprOpenGL->renderTexture(cache->getTexture(), cell, {});
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVTopLeft = Vector2D(-1, -1);
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVBottomRight = Vector2D(-1, -1);
+}
+
+void HTPassElement::draw_cell_capture(bool begin) {
+    CFramebuffer* cache = data.cell_cache;
+    const PHLMONITOR monitor = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    if (cache == nullptr || monitor == nullptr)
+        return;
+
+    if (!begin) {
+        if (data.capture_target == nullptr)
+            return;
+        data.capture_target->bind();
+        data.capture_target = nullptr;
+        return;
+    }
+
+    // Monitor sized like the shared layers cache, so the cells' elements draw into it through
+    // the monitor's projection at the boxes they would have on the monitor
+    const Vector2D fb_size = monitor->m_pixelSize;
+    if (!cache->isAllocated() || cache->m_size != fb_size)
+        cache->alloc(fb_size.x, fb_size.y, monitor->m_output->state->state().drmFormat);
+
+    // Only the cells of this run are cleared, the others stay cached
+    data.capture_target = g_pHyprOpenGL->m_renderData.currentFB;
+    const CRegion damage = g_pHyprOpenGL->m_renderData.damage;
+    CRegion boxes;
+    for (const CBox& box : data.cell_boxes)
+        boxes.add(box);
+    g_pHyprOpenGL->m_renderData.damage = boxes;
+    cache->bind();
+    g_pHyprOpenGL->clear(CHyprColor(0, 0, 0, 0));
+    g_pHyprOpenGL->m_renderData.damage = damage;
+}
+
+void HTPassElement::draw_cell_composite() {
+    CFramebuffer* cache = data.cell_cache;
+    const PHLMONITOR monitor = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    if (cache == nullptr || !cache->isAllocated() || monitor == nullptr)
+        return;
+
+    // Each cell samples its own box of the cache, which is where it was captured
+    const Vector2D fb_size = cache->m_size;
+    for (const CBox& box : data.cell_boxes) {
+        g_pHyprOpenGL->m_renderData.primarySurfaceUVTopLeft = box.pos() / fb_size;
+        g_pHyprOpenGL->m_renderData.primarySurfaceUVBottomRight =
+            (box.pos() + box.size()) / fb_size;
+        g_pHyprOpenGL->renderTexture(cache->getTexture(), box, {});
+    }
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVTopLeft = Vector2D(-1, -1);
+    g_pHyprOpenGL->m_renderData.primarySurfaceUVBottomRight = Vector2D(-1, -1);
+}
+
+void HTPassElement::draw_search_text() {
+    const PHLMONITOR monitor = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    SSearchText* cache = data.search_text_cache;
+    if (monitor == nullptr || cache == nullptr || data.search_text.empty())
+        return;
+
+    if (cache->texture == nullptr || cache->text != data.search_text
+        || cache->scale != monitor->m_scale) {
+        cache->text = data.search_text;
+        cache->scale = monitor->m_scale;
+        cache->texture = g_pHyprOpenGL->renderText(
+            cache->text,
+            CHyprColor(1.f, 1.f, 1.f, 1.f),
+            16 * cache->scale
+        );
+    }
+    const SP<CTexture>& texture = cache->texture;
+    if (texture == nullptr)
+        return;
+
+    const double padding = 8 * monitor->m_scale;
+    const CBox text_box = {
+        {(monitor->m_pixelSize.x - texture->m_size.x) / 2, 32 * monitor->m_scale},
+        texture->m_size,
+    };
+    g_pHyprOpenGL->renderRect(text_box.copy().expand(padding), data.highlight, {});
+    g_pHyprOpenGL->renderTexture(texture, text_box, {});
+}
+
+void HTPassElement::draw_overlay() {
+    for (const CBox& box : data.highlight_boxes)
+        g_pHyprOpenGL->renderRect(box, data.highlight, {});
+    draw_search_text();
+
+    if (data.borders.empty() || data.border_size <= 0.f)
+        return;
+
+    const int border_size = std::round(data.border_size);
+    for (const SBorder& border : data.borders) {
+        g_pHyprOpenGL->renderBorder(
+            border.box,
+            border.active ? data.active_grad : data.inactive_grad,
+            {.borderSize = border_size}
+        );
+    }
+}
+
 bool HTPassElement::needsLiveBlur() {
     return false;
 }
 
 bool HTPassElement::needsPrecomputeBlur() {
     // hyprexpo uses false
-    return true;
+    return data.precompute_blur;
 }
 
 bool HTPassElement::disableSimplification() {
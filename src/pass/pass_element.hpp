@@ -1,10 +1,99 @@
 #pragma once
 
+#include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/helpers/Color.hpp>
+#include <hyprland/src/render/Framebuffer.hpp>
+#include <hyprland/src/render/Texture.hpp>
 #include <hyprland/src/render/pass/PassElement.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Region.hpp>
+#include <string>
+#include <vector>
 
+// Draws the overview's own chrome. An overview frame has one underlay (background,
+// below every cell) and one overlay (all cell borders, above every cell), so the
+// chrome costs the same number of pass elements regardless of how many cells there are.
+// This only consolidates elements: the overlay still issues one renderBorder per cell.
+// The shared layers element sits between the two, under the cells' windows. The spread
+// dim is a plain rect like the underlay but is queued after the cells, so it covers them.
+// The cell blur pair brackets one cell's windows and switches them to the monitor's shared
+// blur while the cell draws, since Hyprland decides between live and shared blur at draw time.
+// The cell capture pair redirects the cells queued between them into the layout's cell cache,
+// and the composite draws every cell that did not change since from that cache, one textured
+// quad per cell with no per-window work.
+// Elements only point at SData kept by the layout, so queueing one allocates just the element
 class HTPassElement: public IPassElement {
   public:
-    HTPassElement();
+    enum eLayer {
+        HT_PASS_UNDERLAY,
+        HT_PASS_SHARED_LAYERS,
+        HT_PASS_DIM,
+        HT_PASS_CELL_BLUR_BEGIN,
+        HT_PASS_CELL_BLUR_END,
+        HT_PASS_CELL_CAPTURE_BEGIN,
+        HT_PASS_CELL_CAPTURE_END,
+        HT_PASS_CELL_COMPOSITE,
+        HT_PASS_OVERLAY,
+    };
+
+    struct SLayerTexture {
+        SP<CTexture> texture;
+        CBox box;
+    };
+
+    struct SBorder {
+        CBox box;
+        bool active;
+    };
+
+    // The search query rendered to a texture, kept by the layout of one monitor and only
+    // rendered again when the query or that monitor's scale changes
+    struct SSearchText {
+        std::string text;
+        double scale = 0.;
+        SP<CTexture> texture;
+    };
+
+    // Owned by the layout, which outlives the frame, and cleared rather than reassigned
+    // between frames so its vectors keep their capacity
+    struct SData {
+        // underlay, which asks Hyprland to have the monitor's blur ready for the cells.
+        // The dim uses the same boxes and colour, without the blur
+        std::vector<CBox> background_boxes;
+        CHyprColor background;
+        bool precompute_blur = false;
+
+        // shared layers, drawn into the top left layer_cache_size of layer_cache once and
+        // then copied into every cell
+        std::vector<SLayerTexture> layer_textures;
+        std::vector<CBox> layer_cells;
+        CFramebuffer* layer_cache = nullptr;
+        Vector2D layer_cache_size;
+
+        // cell blur, the windows of the cell between the pair, shared by both elements
+        std::vector<PHLWINDOWREF> blur_windows;
+
+        // cell capture and composite, cells kept in cell_cache at the same boxes they have on
+        // the monitor. Capture clears cell_boxes and draws into them, the composite copies
+        // them out. The begin element saves the target it replaced for the end element
+        std::vector<CBox> cell_boxes;
+        CFramebuffer* cell_cache = nullptr;
+        mutable CFramebuffer* capture_target = nullptr;
+
+        // overlay, highlights are drawn first and gradients are shared by every border
+        std::vector<CBox> highlight_boxes;
+        CHyprColor highlight;
+        // the search query, shown at the top of the monitor on the highlight colour
+        std::string search_text;
+        SSearchText* search_text_cache = nullptr;
+        std::vector<SBorder> borders;
+        Config::CGradientValueData active_grad;
+        Config::CGradientValueData inactive_grad;
+        float border_size = 0.f;
+    };
+
+    HTPassElement(eLayer layer, const SData* data);
     virtual ~HTPassElement() = default;
 
     virtual std::vector<UP<IPassElement>> draw() override;
@@ -18,4 +107,17 @@ class HTPassElement: public IPassElement {
     virtual const char* passName() override {
         return "HTDisableSimplification";
     }
+
+  private:
+    eLayer layer;
+    const SData& data;
+
+    // Fills background_boxes, for the underlay and the dim
+    void draw_rects();
+    void draw_shared_layers();
+    void draw_cell_blur(bool begin);
+    void draw_cell_capture(bool begin);
+    void draw_cell_composite();
+    void draw_overlay();
+    void draw_search_text();
 };
@@ -1,5 +1,7 @@
 #include "render.hpp"
 
+#include <format>
+
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/config/ConfigValue.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
@@ -9,13 +11,148 @@
 #include <hyprland/src/render/pass/RendererHintsPassElement.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 
+#include "config.hpp"
 #include "globals.hpp"
 #include "src/helpers/time/Time.hpp"
 #include "types.hpp"
 
 using namespace Render;
+
+void HTFrameAllocStats::begin_frame() {
+    frame_start_pass_elements = pass_elements;
+    frame_start_layout_nodes = layout_nodes;
+    frame_start_storage_growths = storage_growths;
+}
+
+void HTFrameAllocStats::end_frame() {
+    frames++;
+    last_pass_elements = pass_elements - frame_start_pass_elements;
+    last_layout_nodes = layout_nodes - frame_start_layout_nodes;
+    last_storage_growths = storage_growths - frame_start_storage_growths;
+}
+
+#ifdef HT_RENDER_RECORDER
+void HTRenderRecorder::begin_frame() {
+    current.workspaces.clear();
+    current.windows.clear();
+    current.pass_elements = 0;
+    current.blur_skipped = 0;
+    current.cached_cells = 0;
+}
+
+void HTRenderRecorder::end_frame() {
+    frames++;
+    last = current;
+    // Damage from input handlers lands between frames, count it towards the next one
+    current.damage_calls = 0;
+}
+
+static std::string json_escape(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (const char c : in) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if ((unsigned char)c < 0x20)
+            out += std::format("\\u{:04x}", c);
+        else
+            out += c;
+    }
+    return out;
+}
+
+std::string HTRenderRecorder::json() const {
+    std::string out = std::format(
+        "{{\"frames\":{},\"pass_elements\":{},\"damage_calls\":{},\"blur_skipped\":{},"
+        "\"cached_cells\":{},\"workspaces\":[",
+        frames,
+        last.pass_elements,
+        last.damage_calls,
+        last.blur_skipped,
+        last.cached_cells
+    );
+    for (size_t i = 0; i < last.workspaces.size(); i++) {
+        const auto& draw = last.workspaces[i];
+        out += std::format(
+            "{}{{\"monitor\":{},\"workspace\":{},\"x\":{},\"y\":{},\"w\":{},\"h\":{}}}",
+            i == 0 ? "" : ",",
+            draw.monitor,
+            draw.workspace,
+            draw.box.x,
+            draw.box.y,
+            draw.box.w,
+            draw.box.h
+        );
+    }
+    out += "],\"windows\":[";
+    for (size_t i = 0; i < last.windows.size(); i++)
+        out += std::format("{}\"{}\"", i == 0 ? "" : ",", json_escape(last.windows[i].window));
+    out += "]}";
+    return out;
+}
+#endif
+
+void begin_overview_frame() {
+    ht_alloc_stats.begin_frame();
+#ifdef HT_RENDER_RECORDER
+    ht_render_recorder.begin_frame();
+#endif
+}
+
+void end_overview_frame() {
+    ht_alloc_stats.end_frame();
+#ifdef HT_RENDER_RECORDER
+    ht_render_recorder.end_frame();
+#endif
+}
+
+void render_workspace_original(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& box
+) {
+#ifdef HT_RENDER_RECORDER
+    ht_render_recorder.current.workspaces.push_back(
+        {monitor->m_id, workspace != nullptr ? workspace->m_id : WORKSPACE_INVALID, box}
+    );
+#else
+    ((render_workspace_t)(render_workspace_hook->m_original))(
+        g_pHyprRenderer.get(),
+        monitor,
+        workspace,
+        time,
+        box
+    );
+#endif
+}
+
+void damage_monitor(PHLMONITOR monitor) {
+#ifdef HT_RENDER_RECORDER
+    // Counted but still issued, so recorded overviews keep producing frames like real ones
+    ht_render_recorder.current.damage_calls++;
+#endif
+    g_pHyprRenderer->damageMonitor(monitor);
+}
+
+HTCellBlurMode cell_blur_mode(double cell_scale) {
+    const Config::INTEGER mode = HTConfig::value<Config::INTEGER>("cell_blur");
+    if (mode == HT_CELL_BLUR_OFF)
+        return HT_CELL_BLUR_OFF;
+    if (mode == HT_CELL_BLUR_SHARED
+        && cell_scale < HTConfig::value<Config::FLOAT>("cell_blur_live_scale"))
+        return HT_CELL_BLUR_SHARED;
+    return HT_CELL_BLUR_LIVE;
+}
+
 // Note: box is relative to (0, 0), not monitor
-void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, CBox box) {
+void render_window_at_box(
+    PHLWINDOW window,
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    CBox box,
+    bool damage
+) {
     if (!window || !monitor)
         return;
 
@@ -30,11 +167,13 @@ void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::stea
     SRenderModifData data {};
     data.modifs.push_back({SRenderModifData::eRenderModifType::RMOD_TYPE_TRANSLATE, transform});
     data.modifs.push_back({SRenderModifData::eRenderModifType::RMOD_TYPE_SCALE, scale});
-    g_pHyprRenderer->m_renderPass.add(
-        makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData {data})
-    );
+    add_pass_element<CRendererHintsPassElement>(CRendererHintsPassElement::SData {data});
 
-    g_pHyprRenderer->damageWindow(window);
+#ifdef HT_RENDER_RECORDER
+    ht_render_recorder.current.windows.push_back({monitor->m_id, window->m_title});
+#else
+    if (damage)
+        g_pHyprRenderer->damageWindow(window);
     ((render_window_t)render_window)(
         g_pHyprRenderer.get(),
         window,
@@ -45,8 +184,9 @@ void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::stea
         false,
         true
     );
+#endif
 
-    g_pHyprRenderer->m_renderPass.add(makeUnique<CRendererHintsPassElement>(
+    add_pass_element<CRendererHintsPassElement>(
         CRendererHintsPassElement::SData {SRenderModifData {}}
-    ));
+    );
 }
@@ -1,8 +1,130 @@
 #pragma once
 
+#include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/render/Renderer.hpp>
 #include <hyprutils/math/Box.hpp>
 
-void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, CBox box);
+// Heap allocations made by plugin code while rendering the overview: pass elements, layout
+// nodes and growth of the pooled per-frame storage. Pass elements are owned (and freed) by
+// Hyprland's render pass so they cannot be pooled, only counted; a steady-state frame should
+// add nothing else. Allocations inside the Hyprland functions the plugin calls are not counted
+struct HTFrameAllocStats {
+    uint64_t frames = 0;
+    uint64_t pass_elements = 0;
+    uint64_t layout_nodes = 0;
+    uint64_t storage_growths = 0;
+
+    // Counts of the last completed frame
+    uint64_t last_pass_elements = 0;
+    uint64_t last_layout_nodes = 0;
+    uint64_t last_storage_growths = 0;
+
+    uint64_t frame_start_pass_elements = 0;
+    uint64_t frame_start_layout_nodes = 0;
+    uint64_t frame_start_storage_growths = 0;
+
+    void begin_frame();
+    void end_frame();
+};
+
+inline HTFrameAllocStats ht_alloc_stats;
+
+// push_back into storage that is cleared and reused every frame, counting the allocation
+// when it has to grow
+template<typename V, typename T>
+void pool_push(V& storage, T&& value) {
+    if (storage.size() == storage.capacity())
+        ht_alloc_stats.storage_growths++;
+    storage.push_back(std::forward<T>(value));
+}
+
+#ifdef HT_RENDER_RECORDER
+// Built with -Drender_recorder=true: the overview's render calls are recorded instead of
+// issued, so layouts can be driven and checked without a GPU
+struct HTRenderRecord {
+    struct SWorkspaceDraw {
+        MONITORID monitor;
+        WORKSPACEID workspace;
+        CBox box;
+    };
+    struct SWindowDraw {
+        MONITORID monitor;
+        std::string window;
+    };
+
+    std::vector<SWorkspaceDraw> workspaces;
+    std::vector<SWindowDraw> windows;
+    size_t pass_elements = 0;
+    size_t damage_calls = 0;
+    // Windows drawn with shared or no blur instead of blurring live behind themselves
+    size_t blur_skipped = 0;
+    // Cells drawn from the cell cache, which are not in workspaces
+    size_t cached_cells = 0;
+};
+
+struct HTRenderRecorder {
+    uint64_t frames = 0;
+    HTRenderRecord current;
+    // Last completed frame
+    HTRenderRecord last;
+
+    void begin_frame();
+    void end_frame();
+    // The last frame, for `hyprctl hyprtasking-record`
+    std::string json() const;
+};
+
+inline HTRenderRecorder ht_render_recorder;
+#endif
+
+// Every pass element the plugin creates goes through here so it is counted
+template<typename T, typename... Args>
+void add_pass_element(Args&&... args) {
+    ht_alloc_stats.pass_elements++;
+#ifdef HT_RENDER_RECORDER
+    ht_render_recorder.current.pass_elements++;
+#else
+    g_pHyprRenderer->m_renderPass.add(makeUnique<T>(std::forward<Args>(args)...));
+#endif
+}
+
+// Frame boundaries of an overview render, called by the layouts
+void begin_overview_frame();
+void end_overview_frame();
+
+// Hyprland's own renderWorkspace, bypassing the plugin's hook
+void render_workspace_original(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& box
+);
+// Every monitor damage the plugin causes goes through here so the recorder can count it
+void damage_monitor(PHLMONITOR monitor);
+
+// plugin:hyprtasking:cell_blur
+enum HTCellBlurMode {
+    // no blur inside cells
+    HT_CELL_BLUR_OFF = 0,
+    // small cells sample the monitor's blur, computed once per frame it is dirty, instead of
+    // blurring behind every window
+    HT_CELL_BLUR_SHARED = 1,
+    // every window blurs the way Hyprland would
+    HT_CELL_BLUR_LIVE = 2,
+};
+
+// The policy for one cell, cell_scale is the cell's size relative to the monitor. Shared only
+// applies to cells smaller than cell_blur_live_scale, larger ones blur live
+HTCellBlurMode cell_blur_mode(double cell_scale);
+
+// damage keeps the window damaged for the next frame, for windows drawn away from where they are
+void render_window_at_box(
+    PHLWINDOW window,
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    CBox box,
+    bool damage = true
+);
@@ -0,0 +1,276 @@
+#include "search.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+
+namespace HTSearch {
+
+struct SEntry {
+    PHLWINDOWREF window;
+    // Lowercased title, class and initial class separated by '\x1f'
+    std::string text;
+    // Sorted and unique
+    std::vector<uint32_t> trigrams;
+    // Class as indexed; class changes have no event, so they are picked up before a query
+    std::string window_class;
+};
+
+static std::vector<SEntry> entries;
+static std::vector<uint32_t> free_entries;
+static std::unordered_map<const Desktop::View::CWindow*, uint32_t> entry_of;
+// Entries containing each trigram, unordered
+static std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+
+static std::string current_query;
+// Entries matching current_query, ordered by workspace
+static std::vector<uint32_t> match_ids;
+static size_t selected_idx = 0;
+
+static std::string lowercase(std::string s) {
+    for (char& c : s)
+        c = std::tolower((unsigned char)c);
+    return s;
+}
+
+static uint32_t trigram(const char* s) {
+    return ((uint32_t)(unsigned char)s[0] << 16) | ((uint32_t)(unsigned char)s[1] << 8)
+        | (uint32_t)(unsigned char)s[2];
+}
+
+static std::string window_text(const PHLWINDOW& window) {
+    return lowercase(window->m_title) + '\x1f' + lowercase(window->m_class) + '\x1f'
+        + lowercase(window->m_initialClass);
+}
+
+static void index_entry(uint32_t id) {
+    SEntry& entry = entries[id];
+    entry.trigrams.clear();
+    for (size_t i = 0; i + 3 <= entry.text.size(); i++)
+        entry.trigrams.push_back(trigram(entry.text.data() + i));
+    std::sort(entry.trigrams.begin(), entry.trigrams.end());
+    entry.trigrams.erase(
+        std::unique(entry.trigrams.begin(), entry.trigrams.end()),
+        entry.trigrams.end()
+    );
+    for (const uint32_t gram : entry.trigrams)
+        postings[gram].push_back(id);
+}
+
+static void unindex_entry(uint32_t id) {
+    for (const uint32_t gram : entries[id].trigrams) {
+        const auto it = postings.find(gram);
+        if (it == postings.end())
+            continue;
+        std::vector<uint32_t>& list = it->second;
+        const auto pos = std::find(list.begin(), list.end(), id);
+        if (pos != list.end()) {
+            *pos = list.back();
+            list.pop_back();
+        }
+        if (list.empty())
+            postings.erase(it);
+    }
+    entries[id].trigrams.clear();
+}
+
+static bool entry_matches(uint32_t id) {
+    const SEntry& entry = entries[id];
+    return !entry.window.expired() && entry.text.find(current_query) != std::string::npos;
+}
+
+static void sort_matches() {
+    auto workspace_of = [](uint32_t id) {
+        const PHLWINDOW window = entries[id].window.lock();
+        return window == nullptr ? WORKSPACE_INVALID : window->workspaceID();
+    };
+    std::sort(match_ids.begin(), match_ids.end(), [&](uint32_t a, uint32_t b) {
+        const WORKSPACEID wa = workspace_of(a);
+        const WORKSPACEID wb = workspace_of(b);
+        return wa != wb ? wa < wb : a < b;
+    });
+    selected_idx = 0;
+}
+
+// narrowing: the query only grew, so every match is among the previous matches
+static void run_query(bool narrowing) {
+    if (current_query.empty()) {
+        match_ids.clear();
+        selected_idx = 0;
+        return;
+    }
+
+    std::vector<uint32_t> candidates;
+    if (narrowing) {
+        candidates = std::move(match_ids);
+    } else if (current_query.size() >= 3) {
+        const std::vector<uint32_t>* rarest = nullptr;
+        for (size_t i = 0; i + 3 <= current_query.size(); i++) {
+            const auto it = postings.find(trigram(current_query.data() + i));
+            if (it == postings.end()) {
+                rarest = nullptr;
+                candidates.clear();
+                break;
+            }
+            if (rarest == nullptr || it->second.size() < rarest->size())
+                rarest = &it->second;
+        }
+        if (rarest != nullptr)
+            candidates = *rarest;
+    } else {
+        candidates.reserve(entries.size());
+        for (uint32_t id = 0; id < entries.size(); id++)
+            candidates.push_back(id);
+    }
+
+    match_ids.clear();
+    for (const uint32_t id : candidates) {
+        if (entry_matches(id))
+            match_ids.push_back(id);
+    }
+    sort_matches();
+}
+
+void rebuild() {
+    entries.clear();
+    free_entries.clear();
+    entry_of.clear();
+    postings.clear();
+    match_ids.clear();
+    for (const PHLWINDOW& window : g_pCompositor->m_windows)
+        add_window(window);
+}
+
+void add_window(PHLWINDOW window) {
+    if (window == nullptr || entry_of.contains(window.get()))
+        return;
+
+    uint32_t id;
+    if (!free_entries.empty()) {
+        id = free_entries.back();
+        free_entries.pop_back();
+    } else {
+        id = entries.size();
+        entries.emplace_back();
+    }
+    entry_of[window.get()] = id;
+    entries[id].window = window;
+    entries[id].text = window_text(window);
+    entries[id].window_class = window->m_class;
+    index_entry(id);
+
+    if (!current_query.empty() && entry_matches(id)) {
+        match_ids.push_back(id);
+        sort_matches();
+    }
+}
+
+void remove_window(PHLWINDOW window) {
+    if (window == nullptr)
+        return;
+    const auto it = entry_of.find(window.get());
+    if (it == entry_of.end())
+        return;
+
+    const uint32_t id = it->second;
+    entry_of.erase(it);
+    unindex_entry(id);
+    entries[id].window.reset();
+    entries[id].text.clear();
+    entries[id].window_class.clear();
+    free_entries.push_back(id);
+
+    std::erase(match_ids, id);
+    if (selected_idx >= match_ids.size())
+        selected_idx = 0;
+}
+
+void update_window(PHLWINDOW window) {
+    if (window == nullptr)
+        return;
+    const auto it = entry_of.find(window.get());
+    if (it == entry_of.end()) {
+        add_window(window);
+        return;
+    }
+
+    const uint32_t id = it->second;
+    entries[id].window_class = window->m_class;
+    std::string text = window_text(window);
+    if (text == entries[id].text)
+        return;
+    unindex_entry(id);
+    entries[id].text = std::move(text);
+    index_entry(id);
+
+    if (current_query.empty())
+        return;
+    std::erase(match_ids, id);
+    if (entry_matches(id))
+        match_ids.push_back(id);
+    sort_matches();
+}
+
+// Re-index windows whose class changed since they were indexed
+static void refresh_classes() {
+    for (const SEntry& entry : entries) {
+        const PHLWINDOW window = entry.window.lock();
+        if (window != nullptr && window->m_class != entry.window_class)
+            update_window(window);
+    }
+}
+
+const std::string& query() {
+    return current_query;
+}
+
+void append(const std::string& text) {
+    refresh_classes();
+    current_query += lowercase(text);
+    run_query(current_query.size() > text.size());
+}
+
+void pop() {
+    if (current_query.empty())
+        return;
+    // Drop UTF-8 continuation bytes along with their lead byte
+    size_t len = current_query.size() - 1;
+    while (len > 0 && ((unsigned char)current_query[len] & 0xC0) == 0x80)
+        len--;
+    current_query.resize(len);
+    refresh_classes();
+    run_query(false);
+}
+
+void clear_query() {
+    current_query.clear();
+    match_ids.clear();
+    selected_idx = 0;
+}
+
+std::vector<PHLWINDOW> matches() {
+    std::vector<PHLWINDOW> result;
+    result.reserve(match_ids.size());
+    for (const uint32_t id : match_ids) {
+        if (const PHLWINDOW window = entries[id].window.lock())
+            result.push_back(window);
+    }
+    return result;
+}
+
+PHLWINDOW selected() {
+    if (selected_idx >= match_ids.size())
+        return nullptr;
+    return entries[match_ids[selected_idx]].window.lock();
+}
+
+void select_next() {
+    if (match_ids.empty())
+        return;
+    selected_idx = (selected_idx + 1) % match_ids.size();
+}
+
+} // namespace HTSearch
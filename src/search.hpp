@@ -0,0 +1,32 @@
+#pragma once
+
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <string>
+#include <vector>
+
+// Type-to-search over every window's title, class and initial class. Windows are indexed
+// by trigram as they open, close and change title, and class changes are picked up before
+// each query, so a keystroke only looks at windows sharing the query's rarest trigram (or
+// the previous matches, when the query grows)
+namespace HTSearch {
+
+// Index every current window, called once at startup
+void rebuild();
+void add_window(PHLWINDOW window);
+void remove_window(PHLWINDOW window);
+// Re-index after the title or class changed
+void update_window(PHLWINDOW window);
+
+const std::string& query();
+void append(const std::string& text);
+// Removes the last UTF-8 character
+void pop();
+void clear_query();
+
+// Matching windows ordered by workspace, empty while the query is empty
+std::vector<PHLWINDOW> matches();
+// The match Enter jumps to, nullptr if none
+PHLWINDOW selected();
+void select_next();
+
+} // namespace HTSearch
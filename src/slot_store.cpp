@@ -0,0 +1,212 @@
+#include "slot_store.hpp"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+
+namespace HTSlotStore {
+
+// File layout, native endian:
+//   u32 magic, u32 version, u32 monitor count
+//   per monitor: u32 description length, description bytes, u32 slot count,
+//                slot count * {i64 workspace id, i32 layer, i32 x, i32 y}
+static constexpr uint32_t MAGIC = 0x4c535448; // "HTSL"
+static constexpr uint32_t VERSION = 1;
+
+static std::unordered_map<std::string, SlotMap> store;
+
+// One writer thread for the plugin's lifetime. save() only hands it the latest file contents,
+// so the compositor thread never waits on the disk and a burst of saves is written once
+static std::thread writer;
+static std::mutex writer_mutex;
+static std::condition_variable writer_cv;
+static std::optional<std::string> pending_buffer;
+static std::filesystem::path pending_path;
+static bool writer_stop = false;
+
+static std::filesystem::path store_path() {
+    const char* state_home = getenv("XDG_STATE_HOME");
+    if (state_home != nullptr && *state_home != '\0')
+        return std::filesystem::path(state_home) / "hyprtasking" / "slots.bin";
+    const char* home = getenv("HOME");
+    if (home == nullptr)
+        return {};
+    return std::filesystem::path(home) / ".local" / "state" / "hyprtasking" / "slots.bin";
+}
+
+template<typename T>
+static bool read_value(const char*& cursor, const char* end, T& value) {
+    if ((size_t)(end - cursor) < sizeof(T))
+        return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+static bool parse(const char* cursor, const char* end) {
+    uint32_t magic, version, monitor_count;
+    if (!read_value(cursor, end, magic) || !read_value(cursor, end, version)
+        || !read_value(cursor, end, monitor_count))
+        return false;
+    if (magic != MAGIC || version != VERSION)
+        return false;
+
+    for (uint32_t m = 0; m < monitor_count; m++) {
+        uint32_t description_length, slot_count;
+        if (!read_value(cursor, end, description_length)
+            || (size_t)(end - cursor) < description_length)
+            return false;
+        std::string description(cursor, description_length);
+        cursor += description_length;
+        if (!read_value(cursor, end, slot_count))
+            return false;
+
+        SlotMap& slots = store[description];
+        slots.reserve(slot_count);
+        for (uint32_t i = 0; i < slot_count; i++) {
+            int64_t id;
+            int32_t layer, x, y;
+            if (!read_value(cursor, end, id) || !read_value(cursor, end, layer)
+                || !read_value(cursor, end, x) || !read_value(cursor, end, y))
+                return false;
+            slots[id] = HTGridSlot {layer, x, y};
+        }
+    }
+    return true;
+}
+
+void load() {
+    store.clear();
+
+    const std::filesystem::path path = store_path();
+    if (path.empty())
+        return;
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return;
+
+    const char* begin = static_cast<const char*>(data);
+    if (!parse(begin, begin + st.st_size)) {
+        Log::logger->log(ERR, "[Hyprtasking] Ignoring malformed slot store {}", path.string());
+        store.clear();
+    }
+    munmap(data, st.st_size);
+
+    Log::logger->log(LOG, "[Hyprtasking] Restored slots for {} monitors", store.size());
+}
+
+const SlotMap* get(const std::string& monitor_description) {
+    const auto it = store.find(monitor_description);
+    if (it == store.end())
+        return nullptr;
+    return &it->second;
+}
+
+// Writing to a temporary and renaming keeps the file valid for the next load
+static void write_file(const std::filesystem::path& path, const std::string& buffer) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return;
+        out.write(buffer.data(), buffer.size());
+        if (!out.good())
+            return;
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+}
+
+// Writes whatever is pending, newest contents only, and exits once stopped with nothing left
+static void writer_loop() {
+    std::unique_lock lock(writer_mutex);
+    while (true) {
+        writer_cv.wait(lock, [] { return pending_buffer.has_value() || writer_stop; });
+        if (!pending_buffer.has_value())
+            return;
+        const std::string buffer = std::move(*pending_buffer);
+        pending_buffer.reset();
+        const std::filesystem::path path = pending_path;
+        lock.unlock();
+        write_file(path, buffer);
+        lock.lock();
+    }
+}
+
+template<typename T>
+static void write_value(std::string& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void save(const std::string& monitor_description, const SlotMap& slots) {
+    store[monitor_description] = slots;
+
+    std::string buffer;
+    write_value(buffer, MAGIC);
+    write_value(buffer, VERSION);
+    write_value(buffer, (uint32_t)store.size());
+    for (const auto& [description, monitor_slots] : store) {
+        write_value(buffer, (uint32_t)description.size());
+        buffer += description;
+        write_value(buffer, (uint32_t)monitor_slots.size());
+        for (const auto& [id, slot] : monitor_slots) {
+            write_value(buffer, (int64_t)id);
+            write_value(buffer, (int32_t)slot.layer);
+            write_value(buffer, (int32_t)slot.x);
+            write_value(buffer, (int32_t)slot.y);
+        }
+    }
+
+    const std::filesystem::path path = store_path();
+    if (path.empty())
+        return;
+
+    {
+        std::lock_guard lock(writer_mutex);
+        pending_buffer = std::move(buffer);
+        pending_path = path;
+        writer_stop = false;
+    }
+    if (!writer.joinable())
+        writer = std::thread(writer_loop);
+    writer_cv.notify_one();
+}
+
+void shutdown() {
+    {
+        std::lock_guard lock(writer_mutex);
+        writer_stop = true;
+    }
+    writer_cv.notify_one();
+    if (writer.joinable())
+        writer.join();
+}
+
+} // namespace HTSlotStore
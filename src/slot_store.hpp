@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "layout/grid.hpp"
+
+// Grid slot assignments per monitor description, persisted across plugin reloads and
+// compositor restarts in $XDG_STATE_HOME/hyprtasking/slots.bin
+namespace HTSlotStore {
+
+using SlotMap = std::unordered_map<WORKSPACEID, HTGridSlot>;
+
+// Maps the file and reads every monitor's slots, called once at startup
+void load();
+// nullptr if nothing is stored for the monitor
+const SlotMap* get(const std::string& monitor_description);
+// Updates the monitor's slots and writes the file in the background
+void save(const std::string& monitor_description, const SlotMap& slots);
+// Flushes the pending write and stops the writer, called before the plugin is unloaded
+void shutdown();
+
+} // namespace HTSlotStore
@@ -0,0 +1,180 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <format>
+
+#include <hyprland/src/helpers/Monitor.hpp>
+
+#include "globals.hpp"
+#include "layout/grid.hpp"
+#include "overview.hpp"
+
+namespace HTSnapshot {
+
+static uint64_t generation = 1;
+static SData data;
+static std::string json_cache;
+static uint64_t json_generation = 0;
+
+void invalidate() {
+    generation++;
+}
+
+static void rebuild() {
+    data.generation = generation;
+    data.views.clear();
+    if (ht_manager == nullptr)
+        return;
+
+    for (const PHTVIEW& view : ht_manager->views) {
+        if (view == nullptr || view->layout == nullptr)
+            continue;
+        const PHLMONITOR monitor = view->get_monitor();
+        if (monitor == nullptr)
+            continue;
+
+        SView& out = data.views.emplace_back();
+        out.monitor_id = monitor->m_id;
+        out.monitor = monitor->m_name;
+        out.layout = view->layout->layout_name();
+        out.active = view->active;
+        out.closing = view->closing;
+        out.navigating = view->navigating;
+        out.layer = view->layout->layer;
+
+        if (out.layout == "grid") {
+            const auto* grid = static_cast<HTLayoutGrid*>(view->layout.get());
+            for (const auto& [id, slot] : grid->cache())
+                out.slots.push_back({id, slot.layer, slot.x, slot.y});
+            std::sort(out.slots.begin(), out.slots.end(), [](const SSlot& a, const SSlot& b) {
+                return a.id < b.id;
+            });
+        }
+
+        // Cells come from the slot cache or the workspace index rather than overview_layout,
+        // which only holds whatever stage the layout was last built for
+        const auto add_cell = [&](WORKSPACEID id, int x, int y) {
+            const CBox box = view->layout->calculate_ws_box(x, y, HT_VIEW_OPENED);
+            out.cells.push_back({
+                id,
+                x,
+                y,
+                {box.pos() / monitor->m_scale + monitor->m_position, box.size() / monitor->m_scale},
+            });
+        };
+        if (out.layout == "grid") {
+            for (const SSlot& slot : out.slots) {
+                if (slot.layer == out.layer)
+                    add_cell(slot.id, slot.x, slot.y);
+            }
+        } else {
+            // Linear: every workspace on the monitor, then the empty one for a new workspace
+            const auto& workspaces = ht_manager->get_monitor_workspaces(monitor->m_id);
+            for (size_t x = 0; x < workspaces.ids.size(); x++)
+                add_cell(workspaces.ids[x], x, 0);
+            add_cell(workspaces.next_free_id, workspaces.ids.size(), 0);
+        }
+        std::sort(out.cells.begin(), out.cells.end(), [](const SCell& a, const SCell& b) {
+            return a.id < b.id;
+        });
+    }
+    std::sort(data.views.begin(), data.views.end(), [](const SView& a, const SView& b) {
+        return a.monitor_id < b.monitor_id;
+    });
+}
+
+const SData& get() {
+    if (data.generation != generation)
+        rebuild();
+    return data;
+}
+
+static std::string escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (const char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if ((unsigned char)c < 0x20)
+            out += std::format("\\u{:04x}", c);
+        else
+            out += c;
+    }
+    return out;
+}
+
+const std::string& json() {
+    const SData& snapshot = get();
+    if (json_generation == snapshot.generation)
+        return json_cache;
+    json_generation = snapshot.generation;
+
+    std::string& out = json_cache;
+    out = std::format("{{\"generation\":{},\"views\":[", snapshot.generation);
+    for (size_t v = 0; v < snapshot.views.size(); v++) {
+        const SView& view = snapshot.views[v];
+        out += std::format(
+            "{}{{\"monitor\":\"{}\",\"monitor_id\":{},\"layout\":\"{}\",\"active\":{},"
+            "\"closing\":{},\"navigating\":{},\"layer\":{},\"slots\":[",
+            v == 0 ? "" : ",",
+            escape(view.monitor),
+            view.monitor_id,
+            escape(view.layout),
+            view.active,
+            view.closing,
+            view.navigating,
+            view.layer
+        );
+        for (size_t i = 0; i < view.slots.size(); i++) {
+            const SSlot& s = view.slots[i];
+            out += std::format(
+                "{}{{\"id\":{},\"layer\":{},\"x\":{},\"y\":{}}}",
+                i == 0 ? "" : ",",
+                s.id,
+                s.layer,
+                s.x,
+                s.y
+            );
+        }
+        out += "],\"cells\":[";
+        for (size_t i = 0; i < view.cells.size(); i++) {
+            const SCell& c = view.cells[i];
+            out += std::format(
+                "{}{{\"id\":{},\"x\":{},\"y\":{},\"box_x\":{},\"box_y\":{},\"box_w\":{},"
+                "\"box_h\":{}}}",
+                i == 0 ? "" : ",",
+                c.id,
+                c.x,
+                c.y,
+                c.box.x,
+                c.box.y,
+                c.box.w,
+                c.box.h
+            );
+        }
+        out += "]}";
+    }
+    out += "]}";
+    return out;
+}
+
+std::string text() {
+    const SData& snapshot = get();
+    std::string out = std::format("generation {}\n", snapshot.generation);
+    for (const SView& view : snapshot.views) {
+        out += std::format(
+            "{} ({}): active {}, closing {}, navigating {}, layer {}, {} slots, {} cells\n",
+            view.monitor,
+            view.layout,
+            view.active,
+            view.closing,
+            view.navigating,
+            view.layer,
+            view.slots.size(),
+            view.cells.size()
+        );
+    }
+    return out;
+}
+
+} // namespace HTSnapshot
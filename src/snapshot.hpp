@@ -0,0 +1,53 @@
+#pragma once
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <string>
+#include <vector>
+
+// Everything a bar needs to mirror the overview, for the snapshot Lua function and
+// `hyprctl hyprtasking`. Rebuilt lazily when the generation was bumped since the last
+// query, so polling it does not touch layouts or compositor state
+namespace HTSnapshot {
+
+struct SSlot {
+    WORKSPACEID id;
+    int layer;
+    int x;
+    int y;
+};
+
+struct SCell {
+    WORKSPACEID id;
+    int x;
+    int y;
+    // Global logical box of the cell with the overview open
+    CBox box;
+};
+
+struct SView {
+    MONITORID monitor_id;
+    std::string monitor;
+    std::string layout;
+    bool active;
+    bool closing;
+    bool navigating;
+    int layer;
+    // Grid slot map, empty for other layouts
+    std::vector<SSlot> slots;
+    // Cells of the current layer
+    std::vector<SCell> cells;
+};
+
+struct SData {
+    uint64_t generation = 0;
+    std::vector<SView> views;
+};
+
+// Call whenever view state, layers, slots or cell geometry change
+void invalidate();
+const SData& get();
+const std::string& json();
+std::string text();
+
+} // namespace HTSnapshot
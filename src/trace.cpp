@@ -0,0 +1,76 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <vector>
+
+namespace HTTrace {
+
+struct SEvent {
+    const char* name;
+    uint64_t start_us;
+    uint64_t duration_us;
+};
+
+static std::vector<SEvent> events;
+// Next slot to write, wraps around
+static size_t head = 0;
+static bool wrapped = false;
+
+void start(size_t capacity) {
+    events.assign(std::max<size_t>(capacity, 1), SEvent {});
+    head = 0;
+    wrapped = false;
+    enabled = true;
+}
+
+void stop() {
+    enabled = false;
+}
+
+uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+    )
+        .count();
+}
+
+void record(const char* name, uint64_t start_us, uint64_t duration_us) {
+    if (events.empty())
+        return;
+    events[head] = {name, start_us, duration_us};
+    head++;
+    if (head == events.size()) {
+        head = 0;
+        wrapped = true;
+    }
+}
+
+std::string dump(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open())
+        return "could not open " + path;
+
+    out << "{\"traceEvents\":[";
+    const size_t count = wrapped ? events.size() : head;
+    const size_t first = wrapped ? head : 0;
+    for (size_t i = 0; i < count; i++) {
+        const SEvent& e = events[(first + i) % events.size()];
+        out << std::format(
+            "{}{{\"name\":\"{}\",\"cat\":\"hyprtasking\",\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":1,\"tid\":1}}",
+            i == 0 ? "" : ",",
+            e.name,
+            e.start_us,
+            e.duration_us
+        );
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (!out.good())
+        return "could not write " + path;
+    return "";
+}
+
+} // namespace HTTrace
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Ring buffer of timed plugin events, exported as Chrome trace-event JSON
+// (chrome://tracing, ui.perfetto.dev). Recording is off until started and costs a
+// single branch per scope while off.
+namespace HTTrace {
+
+inline bool enabled = false;
+
+// Starts recording into a buffer of capacity events, dropping older ones when full
+void start(size_t capacity);
+void stop();
+// Writes the recorded events to path, returns an error message or "" on success
+std::string dump(const std::string& path);
+
+uint64_t now_us();
+// name must outlive the trace, i.e. be a string literal
+void record(const char* name, uint64_t start_us, uint64_t duration_us);
+
+} // namespace HTTrace
+
+class HTTraceScope {
+  public:
+    HTTraceScope(const char* name) :
+        name(name),
+        start_us(HTTrace::enabled ? HTTrace::now_us() : 0) {}
+
+    ~HTTraceScope() {
+        if (HTTrace::enabled && start_us != 0)
+            HTTrace::record(name, start_us, HTTrace::now_us() - start_us);
+    }
+
+    // Ends the current event and starts the next phase under a new name
+    void next(const char* next_name) {
+        if (!HTTrace::enabled) {
+            start_us = 0;
+            return;
+        }
+        const uint64_t now = HTTrace::now_us();
+        if (start_us != 0)
+            HTTrace::record(name, start_us, now - start_us);
+        name = next_name;
+        start_us = now;
+    }
+
+  private:
+    const char* name;
+    uint64_t start_us;
+};
+
+#define HT_TRACE_CONCAT_INNER(a, b) a##b
+#define HT_TRACE_CONCAT(a, b) HT_TRACE_CONCAT_INNER(a, b)
+// Records the enclosing scope as one trace event
+#define HT_TRACE_SCOPE(name) HTTraceScope HT_TRACE_CONCAT(ht_trace_scope_, __LINE__)(name)
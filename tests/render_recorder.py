@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+# Loads a -Drender_recorder=true build of the plugin into a headless Hyprland, opens the
+# overview on its (headless) monitor and checks what the recorder saw per frame.
+# Exits with 77, which meson reports as skipped, when Hyprland cannot be started here.
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SKIP = 77
+ROWS = 3
+COLS = 3
+# Underlay, shared layers, cell capture pair, composite and overlay, with room for the clear
+# element
+MAX_PASS_ELEMENTS = 8
+# Frames an idle overview may still render after settling, see schedule_next_frame
+MAX_IDLE_FRAMES = 2
+
+CONFIG = f"""
+monitor = , 1920x1080@60, 0x0, 1
+animations {{
+    enabled = false
+}}
+plugin {{
+    hyprtasking {{
+        layout = grid
+        grid {{
+            rows = {ROWS}
+            cols = {COLS}
+        }}
+    }}
+}}
+"""
+
+
+class Hyprctl:
+    def __init__(self, path, env):
+        self.path = path
+        self.env = env
+
+    def __call__(self, *args):
+        try:
+            result = subprocess.run(
+                [self.path, "-i", "0", *args],
+                env=self.env,
+                capture_output=True,
+                text=True,
+                timeout=5,
+            )
+        except subprocess.TimeoutExpired:
+            return None
+        return result.stdout if result.returncode == 0 else None
+
+    def wait_for(self, predicate, *args, tries=100):
+        for _ in range(tries):
+            out = self(*args)
+            if out is not None and predicate(out):
+                return out
+            time.sleep(0.1)
+        return None
+
+    def record(self):
+        out = self("hyprtasking-record")
+        return json.loads(out) if out else None
+
+
+def check(condition, message):
+    if not condition:
+        print(f"FAIL: {message}", file=sys.stderr)
+        sys.exit(1)
+
+
+def run(ctl, plugin):
+    if ctl.wait_for(lambda out: "Hyprland" in out, "version") is None:
+        print("Hyprland did not come up", file=sys.stderr)
+        return SKIP
+    if ctl.wait_for(lambda out: "Monitor" in out, "monitors", tries=10) is None:
+        ctl("output", "create", "headless")
+        if ctl.wait_for(lambda out: "Monitor" in out, "monitors") is None:
+            print("no headless monitor", file=sys.stderr)
+            return SKIP
+
+    loaded = ctl("plugin", "load", plugin)
+    check(loaded is not None and "ok" in loaded, f"plugin load failed: {loaded}")
+    # Config is read before the plugin registers its values, so apply it again
+    ctl("reload")
+
+    check(ctl("dispatch", "hyprtasking:toggle", "all") is not None, "toggle failed")
+    time.sleep(1.0)
+
+    record = ctl.record()
+    check(record is not None, "no render record")
+    check(record["frames"] > 0, "the overview never rendered")
+
+    # Cells that did not change since the last frame come from the cell cache
+    cells = record["workspaces"]
+    drawn = len(cells) + record["cached_cells"]
+    check(0 < drawn <= ROWS * COLS, f"{drawn} workspaces drawn for a {ROWS}x{COLS} grid")
+    check(all(c["w"] > 0 and c["h"] > 0 for c in cells), f"empty cell drawn: {cells}")
+    check(
+        record["pass_elements"] <= MAX_PASS_ELEMENTS,
+        f"{record['pass_elements']} pass elements in one frame",
+    )
+
+    # Nothing moves, so the overview should stop asking for frames
+    settled = record["frames"]
+    time.sleep(0.5)
+    idle = ctl.record()["frames"] - settled
+    check(idle <= MAX_IDLE_FRAMES, f"idle overview rendered {idle} frames in 0.5s")
+
+    check(ctl("dispatch", "hyprtasking:toggle", "all") is not None, "toggle failed")
+    print(
+        f"ok: {drawn} cells ({record['cached_cells']} cached), "
+        f"{record['pass_elements']} pass elements, {idle} idle frames"
+    )
+    return 0
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(f"usage: {sys.argv[0]} PLUGIN.so", file=sys.stderr)
+        return 2
+    plugin = os.path.abspath(sys.argv[1])
+
+    hyprland = shutil.which("Hyprland")
+    hyprctl = shutil.which("hyprctl")
+    if hyprland is None or hyprctl is None:
+        print("Hyprland not installed", file=sys.stderr)
+        return SKIP
+
+    with tempfile.TemporaryDirectory() as runtime:
+        config = os.path.join(runtime, "hyprland.conf")
+        with open(config, "w") as f:
+            f.write(CONFIG)
+
+        # A private runtime dir so hyprctl -i 0 can only reach this instance
+        env = dict(os.environ, XDG_RUNTIME_DIR=runtime, HYPRLAND_HEADLESS_ONLY="1")
+        env.pop("HYPRLAND_INSTANCE_SIGNATURE", None)
+        env.pop("WAYLAND_DISPLAY", None)
+
+        proc = subprocess.Popen(
+            [hyprland, "--config", config],
+            env=env,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+        try:
+            return run(Hyprctl(hyprctl, env), plugin)
+        finally:
+            proc.terminate()
+            try:
+                proc.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                proc.kill()
+
+
+if __name__ == "__main__":
+    sys.exit(main())